@@ -23,6 +23,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -33,16 +34,20 @@ namespace ingen {
    A generic typed data container.
 
    An Atom holds a value with some type and size, both specified by a uint32_t.
-   Values with size less than sizeof(void*) are stored inline: no dynamic
-   allocation occurs so Atoms may be created in hard real-time threads.
-   Otherwise, if the size is larger than sizeof(void*), the value will be
-   dynamically allocated in a separate chunk of memory.
+   Values with size up to inline_size are stored inline: no dynamic allocation
+   occurs so Atoms may be created in hard real-time threads.  This is large
+   enough for numbers and most URIs and short strings, so most properties never
+   allocate.  Otherwise, the value will be dynamically allocated in a separate
+   chunk of memory.
 
    In either case, the data is stored in a binary compatible format to LV2_Atom
    (i.e., if the value is dynamically allocated, the header is repeated there).
 */
 class INGEN_API Atom {
 public:
+	/// Maximum size of a value stored inline, which makes an Atom 64 bytes
+	static constexpr size_t inline_size = 64 - sizeof(LV2_Atom);
+
 	Atom() noexcept = default;
 
 	~Atom() { dealloc(); }
@@ -72,7 +77,7 @@ public:
 
 			memcpy(_body.ptr, copy._body.ptr, sizeof(LV2_Atom) + _atom.size);
 		} else {
-			_body.val = copy._body.val;
+			memcpy(_body.buf, copy._body.buf, _atom.size);
 		}
 	}
 
@@ -88,7 +93,7 @@ public:
 
 			memcpy(_body.ptr, other._body.ptr, sizeof(LV2_Atom) + _atom.size);
 		} else {
-			_body.val = other._body.val;
+			memcpy(_body.buf, other._body.buf, _atom.size);
 		}
 		return *this;
 	}
@@ -100,7 +105,7 @@ public:
 		}
 		return is_reference()
 			? !memcmp(_body.ptr, other._body.ptr, sizeof(LV2_Atom) + _atom.size)
-			: _body.val == other._body.val;
+			: !memcmp(_body.buf, other._body.buf, _atom.size);
 	}
 
 	inline bool operator!=(const Atom& other) const {
@@ -110,9 +115,7 @@ public:
 	inline bool operator<(const Atom& other) const {
 		if (_atom.type == other._atom.type) {
 			const uint32_t min_size = std::min(_atom.size, other._atom.size);
-			const int cmp           = is_reference()
-				? memcmp(_body.ptr, other._body.ptr, min_size)
-				: memcmp(&_body.val, &other._body.val, min_size);
+			const int cmp           = memcmp(get_body(), other.get_body(), min_size);
 			return cmp < 0 || (cmp == 0 && _atom.size < other._atom.size);
 		}
 		return type() < other.type();
@@ -123,11 +126,11 @@ public:
 	 * @return true iff set succeeded.
 	 */
 	inline bool set_rt(const Atom& other) {
-		if (is_reference()) {
+		if (is_reference() || other.is_reference()) {
 			return false;
 		} else {
-			_atom     = other._atom;
-			_body.val = other._body.val;
+			_atom = other._atom;
+			memcpy(_body.buf, other._body.buf, _atom.size);
 			return true;
 		}
 	}
@@ -137,11 +140,11 @@ public:
 	inline bool     is_valid() const { return _atom.type; }
 
 	inline const void* get_body() const {
-		return is_reference() ? static_cast<void*>(_body.ptr + 1) : &_body.val;
+		return is_reference() ? static_cast<void*>(_body.ptr + 1) : _body.buf;
 	}
 
 	inline void* get_body() {
-		return is_reference() ? static_cast<void*>(_body.ptr + 1) : &_body.val;
+		return is_reference() ? static_cast<void*>(_body.ptr + 1) : _body.buf;
 	}
 
 	template <typename T> const T& get() const {
@@ -167,13 +170,13 @@ private:
 
 	/** Return true iff this value is dynamically allocated. */
 	inline bool is_reference() const {
-		return _atom.size > sizeof(_body.val);
+		return _atom.size > inline_size;
 	}
 
 	LV2_Atom _atom = {0, 0};
 	union
 	{
-		intptr_t  val;
+		uint8_t   buf[inline_size];
 		LV2_Atom* ptr;
 	} _body = {};
 };
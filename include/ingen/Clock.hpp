@@ -39,6 +39,11 @@ public:
 		return now * _timebase.numer / _timebase.denom / 1e3;
 	}
 
+	inline uint64_t now_nanoseconds() const {
+		const uint64_t now = mach_absolute_time();
+		return now * _timebase.numer / _timebase.denom;
+	}
+
 private:
 	mach_timebase_info_data_t _timebase;
 
@@ -51,6 +56,13 @@ private:
 		       static_cast<uint64_t>(time.tv_nsec) / 1e3;
 	}
 
+	inline uint64_t now_nanoseconds() const {
+		struct timespec time{};
+		clock_gettime(_clock, &time);
+		return static_cast<uint64_t>(time.tv_sec) * 1000000000ULL +
+		       static_cast<uint64_t>(time.tv_nsec);
+	}
+
 private:
 #	if defined(CLOCK_MONOTONIC_RAW)
 	const clockid_t _clock = CLOCK_MONOTONIC_RAW;
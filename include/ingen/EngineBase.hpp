@@ -26,6 +26,7 @@
 
 namespace ingen {
 
+class FilePath;
 class Interface;
 
 /**
@@ -139,6 +140,17 @@ public:
 	*/
 	virtual bool
 	unregister_client(const std::shared_ptr<Interface>& client) = 0;
+
+	/**
+	   Write a timeline of what every engine thread has been doing recently.
+
+	   The trace is written in Chrome trace event JSON format, which can be
+	   viewed in chrome://tracing or the Perfetto UI.  Tracing must have been
+	   enabled with the trace-file option, otherwise the trace is empty.
+
+	   @return False if the file could not be written.
+	*/
+	virtual bool write_trace(const FilePath& path) = 0;
 };
 
 } // namespace ingen
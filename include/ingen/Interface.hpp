@@ -126,7 +126,10 @@ public:
 
 	inline void redo() { message(Redo{_seq++}); }
 
-	inline void get(const URI& uri) { message(Get{_seq++, uri}); }
+	inline void get(const URI& uri, const Properties& params = Properties())
+	{
+		message(Get{_seq++, uri, params});
+	}
 
 	inline void response(int32_t id, Status status, const std::string& subject)
 	{
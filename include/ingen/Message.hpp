@@ -92,8 +92,9 @@ struct Error
 
 struct Get
 {
-	int32_t seq;
-	URI     subject;
+	int32_t    seq;
+	URI        subject;
+	Properties params;  ///< Options like ingen:depth and ingen:limit
 };
 
 struct Move
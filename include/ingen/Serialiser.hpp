@@ -46,7 +46,11 @@ public:
 
 	virtual ~Serialiser();
 
-	/** Write a graph and all its contents as a complete bundle. */
+	/** Write a graph and all its contents as a complete bundle.
+	 *
+	 * Subgraphs are written as nested bundles, which are written in parallel
+	 * where possible.  Files with unchanged contents are left untouched.
+	 */
 	virtual void
 	write_bundle(const std::shared_ptr<const Node>& graph, const URI& uri);
 
@@ -89,8 +93,9 @@ public:
 
 	/** Finish serialization.
 	 *
-	 * If this is a file serialization, this must be called to finish and close
-	 * the output file, and the empty string is returned.
+	 * If this is a file serialization, this must be called to write the output
+	 * file, and the empty string is returned.  The file is only replaced if its
+	 * contents have changed.
 	 *
 	 * If this is a string serialization, the serialized result is returned.
 	 */
@@ -32,7 +32,11 @@ namespace ingen {
 class Interface;
 class World;
 
-/** Calls Interface methods based on Turtle messages received via socket. */
+/** Calls Interface methods based on Turtle messages received via socket.
+ *
+ * Each reader parses messages in its own thread with its own RDF world, so
+ * messages from several clients are parsed concurrently.
+ */
 class INGEN_API SocketReader
 {
 public:
@@ -72,6 +76,7 @@ private:
 
 	World&                        _world;
 	Interface&                    _iface;
+	SordWorld*                    _rdf_world;
 	SerdEnv*                      _env;
 	SordInserter*                 _inserter;
 	SordNode*                     _msg_node;
@@ -17,11 +17,12 @@
 #ifndef INGEN_SOCKETWRITER_HPP
 #define INGEN_SOCKETWRITER_HPP
 
-#include "ingen/Message.hpp"
 #include "ingen/TurtleWriter.hpp"
 #include "ingen/ingen.h"
+#include "lv2/atom/atom.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 
 namespace raul {
@@ -44,11 +45,12 @@ public:
 	             const URI&                    uri,
 	             std::shared_ptr<raul::Socket> sock);
 
-	void message(const Message& message) override;
+	bool write(const LV2_Atom* msg, int32_t default_id=0) override;
 
 	size_t text_sink(const void* buf, size_t len) override;
 
 protected:
+	URIs&                         _uris;
 	std::shared_ptr<raul::Socket> _socket;
 };
 
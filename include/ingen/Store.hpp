@@ -22,9 +22,14 @@
 #include "raul/Noncopyable.hpp"
 #include "raul/Path.hpp"
 
+#include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
 namespace raul { class Symbol; }
@@ -34,6 +39,15 @@ namespace ingen {
 class Node;
 
 /** Store of objects in the graph hierarchy.
+ *
+ * Objects are kept in a tree sorted by path, so the descendants of an object
+ * immediately follow it, and are also indexed by a hash of their path for
+ * fast point lookups.  Only the modifiers declared here may be used, so that
+ * the index stays in sync.
+ *
+ * The mutex may be locked shared by anything that only reads the store, so
+ * requests for information do not wait for each other.
+ *
  * @ingroup IngenShared
  */
 class INGEN_API Store : public raul::Noncopyable,
@@ -41,6 +55,8 @@ class INGEN_API Store : public raul::Noncopyable,
                         public std::map<const raul::Path, std::shared_ptr<Node>>
 {
 public:
+	using Base = std::map<const raul::Path, std::shared_ptr<Node>>;
+
 	void add(Node* o);
 
 	Node* get(const raul::Path& path) {
@@ -50,7 +66,58 @@ public:
 
 	using const_range = std::pair<const_iterator, const_iterator>;
 	using Objects     = std::map<raul::Path, std::shared_ptr<Node>>;
-	using Mutex       = std::recursive_mutex;
+	using Mutex       = std::shared_timed_mutex;
+
+	iterator find(const raul::Path& path) {
+		const auto i = _index.find(&path);
+		return (i == _index.end()) ? end() : i->second;
+	}
+
+	const_iterator find(const raul::Path& path) const {
+		const auto i = _index.find(&path);
+		return (i == _index.end()) ? end() : const_iterator(i->second);
+	}
+
+	template<typename... Args>
+	std::pair<iterator, bool> emplace(Args&&... args) {
+		const auto r = Base::emplace(std::forward<Args>(args)...);
+		if (r.second) {
+			_index.emplace(&r.first->first, r.first);
+		}
+		return r;
+	}
+
+	std::shared_ptr<Node>& operator[](const raul::Path& path) {
+		const iterator i = find(path);
+		return (i != end()) ? i->second : emplace(path, nullptr).first->second;
+	}
+
+	iterator erase(iterator i) {
+		_index.erase(&i->first);
+		return Base::erase(i);
+	}
+
+	iterator erase(iterator first, iterator last) {
+		for (iterator i = first; i != last; ++i) {
+			_index.erase(&i->first);
+		}
+		return Base::erase(first, last);
+	}
+
+	size_type erase(const raul::Path& path) {
+		const iterator i = find(path);
+		if (i == end()) {
+			return 0;
+		}
+
+		erase(i);
+		return 1;
+	}
+
+	void clear() {
+		_index.clear();
+		Base::clear();
+	}
 
 	iterator       find_descendants_end(Store::iterator parent);
 	const_iterator find_descendants_end(Store::const_iterator parent) const;
@@ -79,6 +146,24 @@ public:
 	Mutex& mutex() { return _mutex; }
 
 private:
+	/// Hash of the path pointed to, so keys in the tree are not duplicated
+	struct PathHash {
+		size_t operator()(const raul::Path* path) const {
+			return std::hash<std::string>()(*path);
+		}
+	};
+
+	/// Equality of the paths pointed to
+	struct PathEqual {
+		bool operator()(const raul::Path* a, const raul::Path* b) const {
+			return *a == *b;
+		}
+	};
+
+	using Index =
+		std::unordered_map<const raul::Path*, iterator, PathHash, PathEqual>;
+
+	Index _index;
 	Mutex _mutex;
 };
 
@@ -24,11 +24,12 @@
 #include "lv2/urid/urid.h"
 #include "raul/Noncopyable.hpp"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace ingen {
@@ -38,11 +39,17 @@ class Node;
 class World;
 
 /** URI to integer map and implementation of LV2 URID extension.
+ *
+ * URIs are interned in an append-only table, so mapping a URI which is already
+ * mapped, and unmapping any URID, is wait-free and realtime safe.  Only
+ * mapping a new URI takes a lock.
+ *
  * @ingroup IngenShared
  */
 class INGEN_API URIMap : public raul::Noncopyable {
 public:
 	URIMap(Log& log, LV2_URID_Map* map, LV2_URID_Unmap* unmap);
+	~URIMap();
 
 	uint32_t    map_uri(const char* uri);
 	uint32_t    map_uri(const std::string& uri) { return map_uri(uri.c_str()); }
@@ -113,9 +120,30 @@ private:
 	std::shared_ptr<URIDMapFeature>   _urid_map_feature;
 	std::shared_ptr<URIDUnmapFeature> _urid_unmap_feature;
 
-	std::mutex                                _mutex;
-	std::unordered_map<std::string, LV2_URID> _map;
-	std::vector<std::string>                  _unmap;
+	/// Number of URIs in the first string segment, which doubles each time
+	static constexpr size_t segment_base = 256;
+
+	/// Maximum number of string segments (enough for 2^32 URIs)
+	static constexpr size_t n_segments = 24;
+
+	/// Open addressing hash table of URIDs, replaced rather than resized
+	struct Table {
+		explicit Table(size_t size);
+
+		const size_t                             mask;
+		std::unique_ptr<std::atomic<LV2_URID>[]> slots;
+	};
+
+	LV2_URID    find(const Table& table, const char* uri, size_t hash) const;
+	LV2_URID    intern(const char* uri);
+	const char* string(LV2_URID urid) const;
+
+	std::mutex                           _mutex;  ///< Held by writers only
+	std::atomic<Table*>                  _table;
+	std::vector<std::unique_ptr<Table>>  _tables;  ///< Current and retired
+	std::atomic<const char**>            _segments[n_segments];
+	std::vector<std::unique_ptr<char[]>> _strings;
+	std::atomic<LV2_URID>                _size;
 };
 
 } // namespace ingen
@@ -100,27 +100,50 @@ public:
 	const Quark ingen_activity;
 	const Quark ingen_arc;
 	const Quark ingen_block;
+	const Quark ingen_blockLength;
 	const Quark ingen_broadcast;
 	const Quark ingen_canvasX;
 	const Quark ingen_canvasY;
+	const Quark ingen_content;
+	const Quark ingen_continuation;
+	const Quark ingen_deadline;
+	const Quark ingen_degradation;
+	const Quark ingen_depth;
 	const Quark ingen_enabled;
+	const Quark ingen_expendable;
 	const Quark ingen_externalContext;
 	const Quark ingen_file;
 	const Quark ingen_head;
 	const Quark ingen_incidentTo;
 	const Quark ingen_internalContext;
+	const Quark ingen_latency;
+	const Quark ingen_limit;
 	const Quark ingen_loadedBundle;
+	const Quark ingen_maxQueueDepth;
 	const Quark ingen_maxRunLoad;
+	const Quark ingen_maxRunTime;
+	const Quark ingen_maxWorkLatency;
 	const Quark ingen_meanRunLoad;
+	const Quark ingen_meanRunTime;
 	const Quark ingen_minRunLoad;
 	const Quark ingen_numThreads;
+	const Quark ingen_offset;
 	const Quark ingen_polyphonic;
 	const Quark ingen_polyphony;
+	const Quark ingen_profile;
 	const Quark ingen_prototype;
+	const Quark ingen_runCount;
+	const Quark ingen_runHistogram;
+	const Quark ingen_sharedInstance;
 	const Quark ingen_sprungLayout;
+	const Quark ingen_structure;
 	const Quark ingen_tail;
 	const Quark ingen_uiEmbedded;
+	const Quark ingen_undoMemory;
 	const Quark ingen_value;
+	const Quark ingen_values;
+	const Quark ingen_workCount;
+	const Quark ingen_workLatency;
 	const Quark log_Error;
 	const Quark log_Note;
 	const Quark log_Trace;
@@ -36,6 +36,7 @@
 #include <algorithm>
 #include <cerrno>
 #include <cstdlib>
+#include <ctime>
 #include <memory>
 #include <vector>
 
@@ -56,6 +57,16 @@ inline bool is_directory(const FilePath& path)
 	return S_ISDIR(info.st_mode);
 }
 
+/** Return the modification time of a file, or 0 if it does not exist. */
+inline time_t last_write_time(const FilePath& path)
+{
+	struct stat info{};
+	if (stat(path.c_str(), &info)) {
+		return 0;
+	}
+	return info.st_mtime;
+}
+
 inline bool create_directories(const FilePath& path)
 {
 	std::vector<FilePath> paths;
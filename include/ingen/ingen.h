@@ -50,26 +50,49 @@
 #define INGEN__activity        INGEN_NS "activity"
 #define INGEN__arc             INGEN_NS "arc"
 #define INGEN__block           INGEN_NS "block"
+#define INGEN__blockLength     INGEN_NS "blockLength"
 #define INGEN__broadcast       INGEN_NS "broadcast"
 #define INGEN__canvasX         INGEN_NS "canvasX"
 #define INGEN__canvasY         INGEN_NS "canvasY"
+#define INGEN__content         INGEN_NS "content"
+#define INGEN__continuation    INGEN_NS "continuation"
+#define INGEN__deadline        INGEN_NS "deadline"
+#define INGEN__degradation     INGEN_NS "degradation"
+#define INGEN__depth           INGEN_NS "depth"
 #define INGEN__enabled         INGEN_NS "enabled"
+#define INGEN__expendable      INGEN_NS "expendable"
 #define INGEN__externalContext INGEN_NS "externalContext"
 #define INGEN__file            INGEN_NS "file"
 #define INGEN__head            INGEN_NS "head"
 #define INGEN__incidentTo      INGEN_NS "incidentTo"
 #define INGEN__internalContext INGEN_NS "internalContext"
+#define INGEN__latency         INGEN_NS "latency"
+#define INGEN__limit           INGEN_NS "limit"
 #define INGEN__loadedBundle    INGEN_NS "loadedBundle"
+#define INGEN__maxQueueDepth   INGEN_NS "maxQueueDepth"
 #define INGEN__maxRunLoad      INGEN_NS "maxRunLoad"
+#define INGEN__maxRunTime      INGEN_NS "maxRunTime"
+#define INGEN__maxWorkLatency  INGEN_NS "maxWorkLatency"
 #define INGEN__meanRunLoad     INGEN_NS "meanRunLoad"
+#define INGEN__meanRunTime     INGEN_NS "meanRunTime"
 #define INGEN__minRunLoad      INGEN_NS "minRunLoad"
 #define INGEN__numThreads      INGEN_NS "numThreads"
+#define INGEN__offset          INGEN_NS "offset"
 #define INGEN__polyphonic      INGEN_NS "polyphonic"
 #define INGEN__polyphony       INGEN_NS "polyphony"
+#define INGEN__profile         INGEN_NS "profile"
 #define INGEN__prototype       INGEN_NS "prototype"
+#define INGEN__runCount        INGEN_NS "runCount"
+#define INGEN__runHistogram    INGEN_NS "runHistogram"
+#define INGEN__sharedInstance  INGEN_NS "sharedInstance"
 #define INGEN__sprungLayout    INGEN_NS "sprungLayout"
+#define INGEN__structure       INGEN_NS "structure"
 #define INGEN__tail            INGEN_NS "tail"
 #define INGEN__uiEmbedded      INGEN_NS "uiEmbedded"
+#define INGEN__undoMemory      INGEN_NS "undoMemory"
 #define INGEN__value           INGEN_NS "value"
+#define INGEN__values          INGEN_NS "values"
+#define INGEN__workCount       INGEN_NS "workCount"
+#define INGEN__workLatency     INGEN_NS "workLatency"
 
 #endif // INGEN_INGEN_H
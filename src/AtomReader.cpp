@@ -176,7 +176,15 @@ AtomReader::write(const LV2_Atom* msg, int32_t default_id)
 
 	if (obj->body.otype == _uris.patch_Get) {
 		if (subject_uri) {
-			_iface(Get{seq, *subject_uri});
+			const LV2_Atom_Object* body = nullptr;
+			lv2_atom_object_get(obj, _uris.patch_body.urid(), &body, 0);
+
+			Properties params;
+			if (body && body->atom.type == _uris.atom_Object) {
+				get_props(body, params);
+			}
+
+			_iface(Get{seq, *subject_uri, params});
 		}
 	} else if (obj->body.otype == _uris.ingen_BundleStart) {
 		_iface(BundleBegin{seq});
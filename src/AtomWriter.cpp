@@ -463,6 +463,25 @@ AtomWriter::operator()(const Redo& message)
  *     a patch:Get ;
  *     patch:subject </main/osc> .
  * @endcode
+ *
+ * A large graph can be fetched in pages by giving options in a body.  The
+ * response to a partial Get sets ingen:continuation on the subject to the
+ * offset of the next page, which is requested with ingen:offset.
+ * ingen:depth limits how deeply blocks are descended into, and ingen:content
+ * can be ingen:structure to omit port values, or ingen:values to get only
+ * port values.
+ *
+ * @code{.ttl}
+ * []
+ *     a patch:Get ;
+ *     patch:subject </main> ;
+ *     patch:body [
+ *         ingen:depth 1 ;
+ *         ingen:offset 100 ;
+ *         ingen:limit 100 ;
+ *         ingen:content ingen:structure
+ *     ] .
+ * @endcode
  */
 void
 AtomWriter::operator()(const Get& message)
@@ -471,6 +490,14 @@ AtomWriter::operator()(const Get& message)
 	forge_request(&msg, _uris.patch_Get, message.seq);
 	lv2_atom_forge_key(&_forge, _uris.patch_subject);
 	forge_uri(message.subject);
+	if (!message.params.empty()) {
+		lv2_atom_forge_key(&_forge, _uris.patch_body);
+
+		LV2_Atom_Forge_Frame body;
+		lv2_atom_forge_object(&_forge, &body, 0, 0);
+		forge_properties(message.params);
+		lv2_atom_forge_pop(&_forge, &body);
+	}
 	lv2_atom_forge_pop(&_forge, &msg);
 	finish_msg();
 }
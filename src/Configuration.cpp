@@ -74,11 +74,28 @@ Configuration::Configuration(Forge& forge)
 	add("save",           "save",           'o', "Save graph", SESSION, forge.String, Atom());
 	add("execute",        "execute",        'x', "File of commands to execute", SESSION, forge.String, Atom());
 	add("path",           "path",           'L', "Target path for loaded graph", SESSION, forge.String, Atom());
+	add("render",         "render",         'R', "Render offline, writing outputs to files in directory", SESSION, forge.String, Atom());
+	add("renderInput",    "render-input",   0,   "Directory of input files for offline rendering", SESSION, forge.String, Atom());
+	add("renderLength",   "render-length",  0,   "Seconds to render offline, or 0 for the longest input", SESSION, forge.Int, forge.make(0));
+	add("renderRate",     "render-rate",    0,   "Sample rate for offline rendering", SESSION, forge.Int, forge.make(48000));
 	add("queueSize",      "queue-size",     'q', "Event queue size", GLOBAL, forge.Int, forge.make(4096));
 	add("flushLog",       "flush-log",      'f', "Flush logs after every entry", GLOBAL, forge.Bool, forge.make(false));
 	add("dump",           "dump",           'd', "Print debug output", SESSION, forge.Bool, forge.make(false));
 	add("trace",          "trace",          't', "Show LV2 plugin trace messages", SESSION, forge.Bool, forge.make(false));
+	add("degrade",        "degrade",        'D', "Shed work when the engine is overloaded", GLOBAL, forge.Bool, forge.make(false));
+	add("profile",        "profile",        'P', "Profile block run times", GLOBAL, forge.Bool, forge.make(false));
+	add("traceFile",      "trace-file",     'T', "Trace engine threads and write timeline to file", SESSION, forge.String, Atom());
+	add("snapshot",       "snapshot",       'k', "Periodically write engine snapshot to file", SESSION, forge.String, Atom());
+	add("snapshotInterval", "snapshot-interval", 'K', "Seconds between engine snapshots", GLOBAL, forge.Int, forge.make(60));
+	add("maxPolyphony",   "max-polyphony",  0,  "Number of voices to allocate when polyphony is increased", GLOBAL, forge.Int, forge.make(0));
+	add("pluginCache",    "plugin-cache",   0,  "Cache plugin discovery results between runs", GLOBAL, forge.Bool, forge.make(true));
+	add("pipelineStages", "pipeline-stages", 0,  "Split root graph into stages run in parallel, each adding a cycle of latency", GLOBAL, forge.Int, forge.make(1));
+	add("sharedThreads",  "shared-threads", 0,  "Share processing threads with other engines in this process", GLOBAL, forge.Bool, forge.make(false));
 	add("threads",        "threads",        'p', "Number of processing threads", GLOBAL, forge.Int, forge.make(int32_t(std::max(std::thread::hardware_concurrency(), 1U))));
+	add("undoMemory",     "undo-memory",    'U', "Maximum memory for undo history in MiB, or 0 for no limit", GLOBAL, forge.Int, forge.make(64));
+	add("warmPool",       "warm-pool",      0,  "Number of spare instances of recently used plugins to keep ready", GLOBAL, forge.Int, forge.make(0));
+	add("workerThreads",  "worker-threads", 'w', "Number of plugin worker threads", GLOBAL, forge.Int, forge.make(2));
+	add("workerPriority", "worker-priority", 'W', "Real-time priority of plugin worker threads, or 0", GLOBAL, forge.Int, forge.make(0));
 	add("humanNames",     "human-names",     0,  "Show human names in GUI", GUI, forge.Bool, forge.make(true));
 	add("portLabels",     "port-labels",     0,  "Show port labels in GUI", GUI, forge.Bool, forge.make(true));
 	add("graphDirectory", "graph-directory", 0,  "Default directory for opening graphs", GUI, forge.String, Atom());
@@ -37,13 +37,18 @@
 #include "sord/sord.h"
 #include "sord/sordmm.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #define NS_RDF   "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
 #define NS_RDFS  "http://www.w3.org/2000/01/rdf-schema#"
@@ -115,8 +120,7 @@ get_properties(ingen::World&                      world,
 	for (Sord::Iter i = model.find(subject, nil, nil); !i.end(); ++i) {
 		if (!skip_property(world.uris(), i.get_predicate())) {
 			forge.clear();
-			forge.read(
-				*world.rdf_world(), model.c_obj(), i.get_object().c_obj());
+			forge.read(model.world(), model.c_obj(), i.get_object().c_obj());
 			const LV2_Atom* atom = forge.atom();
 			Atom            atomm;
 			atomm = Forge::alloc(
@@ -147,6 +151,128 @@ get_properties(ingen::World&                      world,
 
 using PortRecord = std::pair<raul::Path, Properties>;
 
+/** A subgraph file loaded into a model with its own RDF world.
+ *
+ * Loading a file creates nodes, which is not thread safe, so files can only
+ * be loaded in parallel if each has its own world.
+ */
+struct SubModel
+{
+	explicit SubModel(std::string f)
+		: file(std::move(f))
+		, model(world, file, SORD_SPO|SORD_PSO, false)
+	{}
+
+	std::string file;
+	Sord::World world;
+	Sord::Model model;
+};
+
+using SubModels = std::map<std::string, std::unique_ptr<SubModel>>;
+
+static void
+load_model(Sord::Model& model, const std::string& file)
+{
+	const SerdNode base = serd_node_from_string(
+		SERD_URI, reinterpret_cast<const uint8_t*>(file.c_str()));
+
+	SerdEnv* env = serd_env_new(&base);
+	model.load_file(env, SERD_TURTLE, file);
+	serd_env_free(env);
+}
+
+/** Load several subgraph files in parallel. */
+static SubModels
+load_subgraphs(const std::vector<std::string>& files)
+{
+	SubModels               models;
+	std::vector<SubModel*> to_load;
+	for (const auto& f : files) {
+		auto& m = models[f];
+		if (!m) {
+			m = std::make_unique<SubModel>(f);
+			to_load.push_back(m.get());
+		}
+	}
+
+	const size_t n_threads =
+		std::min(to_load.size(),
+		         size_t(std::max(1U, std::thread::hardware_concurrency())));
+
+	if (n_threads <= 1) {
+		for (SubModel* m : to_load) {
+			load_model(m->model, m->file);
+		}
+		return models;
+	}
+
+	std::atomic<size_t>      next{0};
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < n_threads; ++i) {
+		threads.emplace_back([&] {
+			for (size_t m = next++; m < to_load.size(); m = next++) {
+				load_model(to_load[m]->model, to_load[m]->file);
+			}
+		});
+	}
+
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	return models;
+}
+
+/** Return the prototype of a block, or an invalid node. */
+static Sord::Node
+get_prototype(ingen::World& world, Sord::Model& model, const Sord::Node& block)
+{
+	const URIs& uris = world.uris();
+
+	// Try lv2:prototype and old ingen:prototype for backwards compatibility
+	const Sord::URI prototype_predicates[] = {
+		Sord::URI(model.world(), uris.lv2_prototype),
+		Sord::URI(model.world(), uris.ingen_prototype)
+	};
+
+	for (const Sord::URI& pred : prototype_predicates) {
+		Sord::Node prototype = model.get(block, pred, Sord::Node());
+		if (prototype.is_valid()) {
+			return prototype;
+		}
+	}
+
+	return Sord::Node();
+}
+
+/** Return the main file of a subgraph prototype, or empty for a plugin. */
+static std::string
+subgraph_file(const URI& base_uri, const Sord::Node& prototype)
+{
+	const auto* type_uri =
+	    reinterpret_cast<const uint8_t*>(prototype.to_c_string());
+
+	if (serd_uri_string_has_scheme(type_uri) &&
+	    strncmp(reinterpret_cast<const char*>(type_uri), "file:", 5)) {
+		return std::string();  // Prototype is non-file URI, plugin
+	}
+
+	SerdURI base_uri_parts;
+	serd_uri_parse(reinterpret_cast<const uint8_t*>(base_uri.c_str()),
+	               &base_uri_parts);
+
+	SerdURI  ignored;
+	SerdNode sub_uri = serd_node_new_uri_from_string(
+		type_uri,
+		&base_uri_parts,
+		&ignored);
+
+	const std::string sub_uri_str = reinterpret_cast<const char*>(sub_uri.buf);
+	serd_node_free(&sub_uri);
+
+	return sub_uri_str + "/main.ttl";
+}
+
 static boost::optional<PortRecord>
 get_port(ingen::World&     world,
          Sord::Model&      model,
@@ -229,7 +355,8 @@ parse_block(
 	const URI&                         base_uri,
 	const Sord::Node&                  subject,
 	const raul::Path&                  path,
-	const boost::optional<Properties>& data = boost::optional<Properties>());
+	const boost::optional<Properties>& data = boost::optional<Properties>(),
+	const SubModels*                   sub_models = nullptr);
 
 static bool
 parse_arcs(
@@ -247,60 +374,39 @@ parse_block(ingen::World&                      world,
             const URI&                         base_uri,
             const Sord::Node&                  subject,
             const raul::Path&                  path,
-            const boost::optional<Properties>& data)
+            const boost::optional<Properties>& data,
+            const SubModels*                   sub_models)
 {
 	const URIs& uris = world.uris();
 
-	// Try lv2:prototype and old ingen:prototype for backwards compatibility
-	const Sord::URI prototype_predicates[] = {
-		Sord::URI(*world.rdf_world(), uris.lv2_prototype),
-		Sord::URI(*world.rdf_world(), uris.ingen_prototype)
-	};
-
-	// Get prototype
-	Sord::Node prototype;
-	for (const Sord::URI& pred : prototype_predicates) {
-		prototype = model.get(subject, pred, Sord::Node());
-		if (prototype.is_valid()) {
-			break;
-		}
-	}
-
+	const Sord::Node prototype = get_prototype(world, model, subject);
 	if (!prototype.is_valid()) {
 		world.log().error("Block %1% (%2%) missing mandatory lv2:prototype\n",
 		                  subject, path);
 		return boost::optional<raul::Path>();
 	}
 
-	const auto* type_uri =
-	    reinterpret_cast<const uint8_t*>(prototype.to_c_string());
-
-	if (!serd_uri_string_has_scheme(type_uri) ||
-	    !strncmp(reinterpret_cast<const char*>(type_uri), "file:", 5)) {
+	const std::string sub_file = subgraph_file(base_uri, prototype);
+	if (!sub_file.empty()) {
 		// Prototype is a file, subgraph
-		SerdURI base_uri_parts;
-		serd_uri_parse(reinterpret_cast<const uint8_t*>(base_uri.c_str()),
-		               &base_uri_parts);
-
-		SerdURI  ignored;
-		SerdNode sub_uri = serd_node_new_uri_from_string(
-			type_uri,
-			&base_uri_parts,
-			&ignored);
-
-		const std::string sub_uri_str = reinterpret_cast<const char*>(sub_uri.buf);
-		const std::string sub_file    = sub_uri_str + "/main.ttl";
-
 		const SerdNode sub_base = serd_node_from_string(
 		    SERD_URI, reinterpret_cast<const uint8_t*>(sub_file.c_str()));
 
-		Sord::Model sub_model(*world.rdf_world(), sub_file);
-		SerdEnv* env = serd_env_new(&sub_base);
-		sub_model.load_file(env, SERD_TURTLE, sub_file);
-		serd_env_free(env);
+		// Use the model if it was loaded in advance, otherwise load it now
+		std::unique_ptr<SubModel> loaded;
+		SubModel*                 sub_model = nullptr;
+		const auto s = sub_models ? sub_models->find(sub_file)
+		                          : SubModels::const_iterator();
+		if (sub_models && s != sub_models->end()) {
+			sub_model = s->second.get();
+		} else {
+			loaded    = std::make_unique<SubModel>(sub_file);
+			sub_model = loaded.get();
+			load_model(sub_model->model, sub_file);
+		}
 
-		Sord::URI sub_node(*world.rdf_world(), sub_file);
-		parse_graph(world, target, sub_model, sub_base,
+		Sord::URI sub_node(sub_model->world, sub_file);
+		parse_graph(world, target, sub_model->model, sub_base,
 		            sub_node, Resource::Graph::INTERNAL,
 		            path.parent(), raul::Symbol(path.symbol()), data);
 
@@ -330,8 +436,10 @@ parse_graph(ingen::World&                        world,
 {
 	const URIs& uris = world.uris();
 
-	const Sord::URI ingen_block(*world.rdf_world(), uris.ingen_block);
-	const Sord::URI lv2_port(*world.rdf_world(),    LV2_CORE__port);
+	const Sord::URI ingen_block(model.world(), uris.ingen_block);
+	const Sord::URI ingen_Graph(model.world(), uris.ingen_Graph);
+	const Sord::URI lv2_port   (model.world(), LV2_CORE__port);
+	const Sord::URI rdf_type   (model.world(), uris.rdf_type);
 
 	const Sord::Node& graph = subject;
 	const Sord::Node  nil;
@@ -385,29 +493,48 @@ parse_graph(ingen::World&                        world,
 		return {graph_path};  // Not parsing graph internals, finished now
 	}
 
-	// For each block in this graph
+	/* Every lookup here is by subject, which is a range of the SPO index of
+	   the model, so statements are only visited once per query and an index
+	   of our own would not save anything.  Just find the blocks once. */
+	std::vector<Sord::Node> blocks;
 	for (Sord::Iter n = model.find(subject, ingen_block, nil); !n.end(); ++n) {
-		Sord::Node node     = n.get_object();
-		URI        node_uri = node;
+		blocks.push_back(n.get_object());
+	}
+
+	/* Load all subgraph files first, in parallel.  These are independent of
+	   each other, but their contents must still be sent in order below. */
+	std::vector<std::string> sub_files;
+	for (const Sord::Node& node : blocks) {
+		const Sord::Node prototype = get_prototype(world, model, node);
+		if (prototype.is_valid()) {
+			const std::string sub_file = subgraph_file(base_uri, prototype);
+			if (!sub_file.empty()) {
+				sub_files.push_back(sub_file);
+			}
+		}
+	}
+
+	const SubModels sub_models = load_subgraphs(sub_files);
+
+	// For each block in this graph
+	for (const Sord::Node& node : blocks) {
+		URI node_uri = node;
 		assert(!node_uri.path().empty() && node_uri.path() != "/");
 		const raul::Path block_path = graph_path.child(
 			raul::Symbol(FilePath(node_uri.path()).stem().string()));
 
 		// Parse and create block
 		parse_block(world, target, model, base_uri, node, block_path,
-		            boost::optional<Properties>());
+		            boost::optional<Properties>(), &sub_models);
+
+		const Resource::Graph subctx =
+			model.ask(node, rdf_type, ingen_Graph) ? Resource::Graph::EXTERNAL
+			                                       : Resource::Graph::DEFAULT;
 
 		// For each port on this block
 		for (Sord::Iter p = model.find(node, lv2_port, nil); !p.end(); ++p) {
 			Sord::Node port = p.get_object();
 
-			Resource::Graph subctx = Resource::Graph::DEFAULT;
-			if (!model.find(node,
-			                Sord::URI(*world.rdf_world(), uris.rdf_type),
-			                Sord::URI(*world.rdf_world(), uris.ingen_Graph)).end()) {
-				subctx = Resource::Graph::EXTERNAL;
-			}
-
 			// Get all properties
 			boost::optional<PortRecord> port_record = get_port(
 				world, model, port, subctx, block_path, nullptr);
@@ -439,8 +566,8 @@ parse_arc(ingen::World&      world,
 {
 	const URIs& uris = world.uris();
 
-	const Sord::URI  ingen_tail(*world.rdf_world(), uris.ingen_tail);
-	const Sord::URI  ingen_head(*world.rdf_world(), uris.ingen_head);
+	const Sord::URI  ingen_tail(model.world(), uris.ingen_tail);
+	const Sord::URI  ingen_head(model.world(), uris.ingen_head);
 	const Sord::Node nil;
 
 	Sord::Iter t = model.find(subject, ingen_tail, nil);
@@ -489,7 +616,7 @@ parse_arcs(ingen::World&      world,
            const Sord::Node&  subject,
            const raul::Path&  graph)
 {
-	const Sord::URI  ingen_arc(*world.rdf_world(), world.uris().ingen_arc);
+	const Sord::URI  ingen_arc(model.world(), world.uris().ingen_arc);
 	const Sord::Node nil;
 
 	for (Sord::Iter i = model.find(subject, ingen_arc, nil); !i.end(); ++i) {
@@ -511,14 +638,14 @@ parse(ingen::World&                        world,
 {
 	const URIs& uris = world.uris();
 
-	const Sord::URI  graph_class   (*world.rdf_world(), uris.ingen_Graph);
-	const Sord::URI  block_class   (*world.rdf_world(), uris.ingen_Block);
-	const Sord::URI  arc_class     (*world.rdf_world(), uris.ingen_Arc);
-	const Sord::URI  internal_class(*world.rdf_world(), uris.ingen_Internal);
-	const Sord::URI  in_port_class (*world.rdf_world(), LV2_CORE__InputPort);
-	const Sord::URI  out_port_class(*world.rdf_world(), LV2_CORE__OutputPort);
-	const Sord::URI  lv2_class     (*world.rdf_world(), LV2_CORE__Plugin);
-	const Sord::URI  rdf_type      (*world.rdf_world(), uris.rdf_type);
+	const Sord::URI  graph_class   (model.world(), uris.ingen_Graph);
+	const Sord::URI  block_class   (model.world(), uris.ingen_Block);
+	const Sord::URI  arc_class     (model.world(), uris.ingen_Arc);
+	const Sord::URI  internal_class(model.world(), uris.ingen_Internal);
+	const Sord::URI  in_port_class (model.world(), LV2_CORE__InputPort);
+	const Sord::URI  out_port_class(model.world(), LV2_CORE__OutputPort);
+	const Sord::URI  lv2_class     (model.world(), LV2_CORE__Plugin);
+	const Sord::URI  rdf_type      (model.world(), uris.rdf_type);
 	const Sord::Node nil;
 
 	// Parse explicit subject graph
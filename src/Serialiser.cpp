@@ -41,24 +41,41 @@
 #include "sord/sordmm.hpp"
 #include "sratom/sratom.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace ingen {
 
 struct Serialiser::Impl
 {
 	explicit Impl(World& world)
+	    : Impl(world, *world.rdf_world(), std::make_shared<std::mutex>())
+	{
+	}
+
+	Impl(World&                      world,
+	     Sord::World&                rdf_world,
+	     std::shared_ptr<std::mutex> state_mutex)
 	    : _root_path("/")
 	    , _mode(Mode::TO_FILE)
 	    , _world(world)
+	    , _rdf_world(rdf_world)
+	    , _state_mutex(std::move(state_mutex))
+	    , _bundles(nullptr)
 	    , _model(nullptr)
 	    , _sratom(sratom_new(&_world.uri_map().urid_map()))
 	{
@@ -73,6 +90,13 @@ struct Serialiser::Impl
 
 	enum class Mode { TO_FILE, TO_STRING };
 
+	/** A graph to be written as a bundle. */
+	struct Bundle
+	{
+		std::shared_ptr<const Node> graph;
+		URI                         uri;
+	};
+
 	void start_to_file(const raul::Path& root, const FilePath& filename);
 
 	std::set<const Resource*>
@@ -91,6 +115,13 @@ struct Serialiser::Impl
 
 	void write_bundle(const std::shared_ptr<const Node>& graph, const URI& uri);
 
+	void write_graph_bundle(const Bundle& bundle, std::vector<Bundle>& children);
+
+	void write_bundles(const std::vector<Bundle>& bundles,
+	                   std::vector<Bundle>&       children);
+
+	bool write_file();
+
 	Sord::Node path_rdf_node(const raul::Path& path) const;
 
 	void write_manifest(const FilePath&                    bundle_path,
@@ -104,13 +135,16 @@ struct Serialiser::Impl
 
 	std::string finish();
 
-	raul::Path   _root_path;
-	Mode         _mode;
-	URI          _base_uri;
-	FilePath     _basename;
-	World&       _world;
-	Sord::Model* _model;
-	Sratom*      _sratom;
+	raul::Path                  _root_path;
+	Mode                        _mode;
+	URI                         _base_uri;
+	FilePath                    _basename;
+	World&                      _world;
+	Sord::World&                _rdf_world;
+	std::shared_ptr<std::mutex> _state_mutex; ///< Shared by parallel writers
+	std::vector<Bundle>*        _bundles;     ///< Subgraph bundles to write
+	Sord::Model*                _model;
+	Sratom*                     _sratom;
 };
 
 Serialiser::Serialiser(World& world) : me{std::make_unique<Impl>(world)} {}
@@ -193,7 +227,28 @@ void
 Serialiser::Impl::write_bundle(const std::shared_ptr<const Node>& graph,
                                const URI&                         uri)
 {
-	FilePath path(uri.path());
+	/* Subgraph bundles are only referenced by their parent, so they are
+	   collected while writing it and written afterwards, a level at a time.
+	   This way, only one model per thread is alive at once, and all the
+	   bundles at a level can be written in parallel. */
+	std::vector<Bundle> bundles{{graph, uri}};
+	while (!bundles.empty()) {
+		std::vector<Bundle> children;
+		if (bundles.size() == 1) {
+			write_graph_bundle(bundles.front(), children);
+		} else {
+			write_bundles(bundles, children);
+		}
+
+		bundles = std::move(children);
+	}
+}
+
+void
+Serialiser::Impl::write_graph_bundle(const Bundle&        bundle,
+                                     std::vector<Bundle>& children)
+{
+	FilePath path(bundle.uri.path());
 	if (filesystem::exists(path) && !filesystem::is_directory(path)) {
 		path = path.parent_path();
 	}
@@ -204,19 +259,61 @@ Serialiser::Impl::write_bundle(const std::shared_ptr<const Node>& graph,
 	const FilePath   main_file     = path / "main.ttl";
 	const raul::Path old_root_path = _root_path;
 
-	start_to_file(graph->path(), main_file);
+	start_to_file(bundle.graph->path(), main_file);
 
+	_bundles = &children;
 	std::set<const Resource*> plugins =
-	    serialise_graph(graph,
-	                    Sord::URI(_model->world(), main_file, _base_uri));
+	    serialise_graph(bundle.graph,
+	                    Sord::URI(_rdf_world, main_file, _base_uri));
+	_bundles = nullptr;
 
 	finish();
-	write_manifest(path, graph);
+	write_manifest(path, bundle.graph);
 	write_plugins(path, plugins);
 
 	_root_path = old_root_path;
 }
 
+void
+Serialiser::Impl::write_bundles(const std::vector<Bundle>& bundles,
+                                std::vector<Bundle>&       children)
+{
+	const size_t n_threads =
+	    std::min(bundles.size(),
+	             size_t(std::max(1U, std::thread::hardware_concurrency())));
+
+	/* Creating nodes modifies the RDF world, so each thread needs its own.
+	   The caller holds the lock on the shared world, so copy its prefixes
+	   here before starting any threads. */
+	std::vector<std::unique_ptr<Sord::World>> rdf_worlds;
+	for (size_t i = 0; i < n_threads; ++i) {
+		rdf_worlds.emplace_back(std::make_unique<Sord::World>());
+		serd_env_foreach(_rdf_world.prefixes().c_obj(),
+		                 reinterpret_cast<SerdPrefixSink>(serd_env_set_prefix),
+		                 rdf_worlds.back()->prefixes().c_obj());
+	}
+
+	std::atomic<size_t>      next{0};
+	std::mutex               children_mutex;
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < n_threads; ++i) {
+		threads.emplace_back([&, i] {
+			Impl                impl(_world, *rdf_worlds[i], _state_mutex);
+			std::vector<Bundle> found;
+			for (size_t b = next++; b < bundles.size(); b = next++) {
+				impl.write_graph_bundle(bundles[b], found);
+			}
+
+			std::lock_guard<std::mutex> lock(children_mutex);
+			children.insert(children.end(), found.begin(), found.end());
+		});
+	}
+
+	for (auto& t : threads) {
+		t.join();
+	}
+}
+
 /** Begin a serialization to a file.
  *
  * This must be called before any serializing methods.
@@ -231,7 +328,7 @@ Serialiser::Impl::start_to_file(const raul::Path& root,
 		_basename = filename.parent_path().stem();
 	}
 
-	_model     = new Sord::Model(*_world.rdf_world(), _base_uri);
+	_model     = new Sord::Model(_rdf_world, _base_uri, SORD_SPO, false);
 	_mode      = Mode::TO_FILE;
 	_root_path = root;
 }
@@ -241,7 +338,7 @@ Serialiser::start_to_string(const raul::Path& root, const URI& base_uri)
 {
 	me->_root_path = root;
 	me->_base_uri  = base_uri;
-	me->_model     = new Sord::Model(*me->_world.rdf_world(), base_uri);
+	me->_model     = new Sord::Model(me->_rdf_world, base_uri, SORD_SPO, false);
 	me->_mode      = Impl::Mode::TO_STRING;
 }
 
@@ -262,11 +359,10 @@ Serialiser::Impl::finish()
 {
 	std::string ret;
 	if (_mode == Mode::TO_FILE) {
-		SerdStatus st = _model->write_to_file(_base_uri, SERD_TURTLE);
-		if (st) {
+		if (!write_file()) {
 			_world.log().error("Error writing file %1% (%2%)\n",
 			                   _base_uri,
-			                   serd_strerror(st));
+			                   strerror(errno));
 		}
 	} else {
 		ret = _model->write_to_string(_base_uri, SERD_TURTLE);
@@ -279,6 +375,80 @@ Serialiser::Impl::finish()
 	return ret;
 }
 
+/** Return true iff two files have identical contents. */
+static bool
+same_contents(const FilePath& a, const FilePath& b)
+{
+	std::unique_ptr<FILE, decltype(&fclose)> fa{fopen(a.c_str(), "rb"), &fclose};
+	std::unique_ptr<FILE, decltype(&fclose)> fb{fopen(b.c_str(), "rb"), &fclose};
+	if (!fa || !fb) {
+		return false;
+	}
+
+	char buf_a[4096];
+	char buf_b[4096];
+	for (;;) {
+		const size_t n_a = fread(buf_a, 1, sizeof(buf_a), fa.get());
+		const size_t n_b = fread(buf_b, 1, sizeof(buf_b), fb.get());
+		if (n_a != n_b || memcmp(buf_a, buf_b, n_a)) {
+			return false;
+		} else if (n_a < sizeof(buf_a)) {
+			return true;
+		}
+	}
+}
+
+/** Write the model to its file, leaving the file untouched if unchanged.
+ *
+ * The model is written to a temporary file which replaces the original only
+ * if they differ, so saving a session only touches the files of subgraphs
+ * that have actually changed.
+ */
+bool
+Serialiser::Impl::write_file()
+{
+	const FilePath path     = _base_uri.file_path();
+	const FilePath tmp_path = FilePath(path.string() + ".tmp");
+
+	FILE* const file = fopen(tmp_path.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+
+	SerdURI base_uri;
+	serd_uri_parse(reinterpret_cast<const uint8_t*>(_base_uri.c_str()),
+	               &base_uri);
+
+	SerdEnv* const    env    = _rdf_world.prefixes().c_obj();
+	SerdWriter* const writer = serd_writer_new(
+	    SERD_TURTLE,
+	    SerdStyle(SERD_STYLE_ABBREVIATED | SERD_STYLE_CURIED |
+	              SERD_STYLE_RESOLVED),
+	    env,
+	    &base_uri,
+	    serd_file_sink,
+	    file);
+
+	serd_env_foreach(env,
+	                 reinterpret_cast<SerdPrefixSink>(serd_writer_set_prefix),
+	                 writer);
+
+	sord_write(_model->c_obj(), writer, nullptr);
+	serd_writer_free(writer);
+
+	const bool error = ferror(file);
+	if (fclose(file) || error) {
+		std::remove(tmp_path.c_str());
+		return false;
+	}
+
+	if (same_contents(tmp_path, path)) {
+		return !std::remove(tmp_path.c_str());
+	}
+
+	return !std::rename(tmp_path.c_str(), path.c_str());
+}
+
 Sord::Node
 Serialiser::Impl::path_rdf_node(const raul::Path& path) const
 {
@@ -378,16 +548,14 @@ Serialiser::Impl::serialise_graph(const std::shared_ptr<const Node>& graph,
 			                            reinterpret_cast<const char*>(
 			                                subgraph_node.buf));
 
-			// Save our state
-			URI          my_base_uri = _base_uri;
-			Sord::Model* my_model    = _model;
-
-			// Write child bundle within this bundle
-			write_bundle(subgraph, subgraph_id);
-
-			// Restore our state
-			_base_uri = my_base_uri;
-			_model    = my_model;
+			if (_bundles) {
+				// Write child bundle after this one is finished
+				_bundles->push_back({subgraph, URI(subgraph_id)});
+			} else {
+				// Not writing a bundle, write child bundle now
+				Impl child(_world, _rdf_world, _state_mutex);
+				child.write_bundle(subgraph, URI(subgraph_id));
+			}
 
 			// Serialise reference to graph block
 			const Sord::Node block_id(path_rdf_node(subgraph->path()));
@@ -460,7 +628,14 @@ Serialiser::Impl::serialise_block(const std::shared_ptr<const Node>& block,
 		const FilePath graph_dir  = base_path.parent_path();
 		const FilePath state_dir  = graph_dir / block->symbol();
 		const FilePath state_file = state_dir / "state.ttl";
-		if (block->save_state(state_dir)) {
+		bool saved = false;
+		{
+			// Plugin state is saved via the shared LV2 world
+			std::lock_guard<std::mutex> lock(*_state_mutex);
+			saved = block->save_state(state_dir);
+		}
+
+		if (saved) {
 			_model->add_statement(block_id,
 			                      Sord::URI(_model->world(), uris.state_state),
 			                      Sord::URI(_model->world(), URI(state_file)));
@@ -536,7 +711,7 @@ Serialiser::Impl::serialise_arc(const Sord::Node&                 parent,
 
 	const Sord::Node src    = path_rdf_node(arc->tail_path());
 	const Sord::Node dst    = path_rdf_node(arc->head_path());
-	const Sord::Node arc_id = Sord::Node::blank_id(*_world.rdf_world(), "arc");
+	const Sord::Node arc_id = Sord::Node::blank_id(_rdf_world, "arc");
 	_model->add_statement(arc_id, Sord::URI(world, uris.ingen_tail), src);
 	_model->add_statement(arc_id, Sord::URI(world, uris.ingen_head), dst);
 
@@ -41,6 +41,7 @@ SocketReader::SocketReader(ingen::World&                 world,
                            std::shared_ptr<raul::Socket> sock)
     : _world(world)
     , _iface(iface)
+    , _rdf_world(nullptr)
     , _env()
     , _inserter(nullptr)
     , _msg_node(nullptr)
@@ -84,7 +85,7 @@ SocketReader::write_statement(SocketReader*      iface,
 {
 	if (!iface->_msg_node) {
 		iface->_msg_node = sord_node_from_serd_node(
-			iface->_world.rdf_world()->c_obj(), iface->_env, subject, nullptr, nullptr);
+			iface->_rdf_world, iface->_env, subject, nullptr, nullptr);
 	}
 
 	return sord_inserter_write_statement(
@@ -118,28 +119,35 @@ SocketReader::c_err(void* stream)
 void
 SocketReader::run()
 {
-	Sord::World*  world = _world.rdf_world();
-	LV2_URID_Map& map   = _world.uri_map().urid_map();
-
-	// Set up a forge to build LV2 atoms from model
-	SordNode*  base_uri = nullptr;
-	SordModel* model    = nullptr;
-	AtomForge  forge(map);
+	/* Parse into a private RDF world rather than the shared one, so readers
+	   for different clients can parse concurrently without taking the global
+	   RDF lock.  Nodes from this world never escape this thread, only the
+	   atoms built from them do. */
+	Sord::World   world;
+	LV2_URID_Map& map = _world.uri_map().urid_map();
 	{
-		// Lock RDF world
+		// Lock shared RDF world just long enough to copy its prefixes
 		std::lock_guard<std::mutex> lock(_world.rdf_mutex());
+		serd_env_foreach(_world.rdf_world()->prefixes().c_obj(),
+		                 reinterpret_cast<SerdPrefixSink>(serd_env_set_prefix),
+		                 world.prefixes().c_obj());
+	}
 
-		// Use <ingen:/> as base URI, so relative URIs are like bundle paths
-		base_uri = sord_new_uri(world->c_obj(),
-		                        reinterpret_cast<const uint8_t*>("ingen:/"));
+	_rdf_world = world.c_obj();
 
-		// Make a model and reader to parse the next Turtle message
-		_env = world->prefixes().c_obj();
-		model = sord_new(world->c_obj(), SORD_SPO, false);
+	// Use <ingen:/> as base URI, so relative URIs are like bundle paths
+	SordNode* base_uri = sord_new_uri(
+		world.c_obj(), reinterpret_cast<const uint8_t*>("ingen:/"));
 
-		// Create an inserter for writing incoming triples to model
-		_inserter = sord_inserter_new(model, _env);
-	}
+	// Make a model and reader to parse the next Turtle message
+	_env             = world.prefixes().c_obj();
+	SordModel* model = sord_new(world.c_obj(), SORD_SPO, false);
+
+	// Create an inserter for writing incoming triples to model
+	_inserter = sord_inserter_new(model, _env);
+
+	// Set up a forge to build LV2 atoms from model
+	AtomForge forge(map);
 
 	SerdReader* reader = serd_reader_new(
 		SERD_TURTLE, this, nullptr,
@@ -175,9 +183,6 @@ SocketReader::run()
 			continue;  // No data, shouldn't happen
 		}
 
-		// Lock RDF world
-		std::lock_guard<std::mutex> lock(_world.rdf_mutex());
-
 		// Read until the next '.'
 		SerdStatus st = serd_reader_read_chunk(reader);
 		if (st == SERD_FAILURE || !_msg_node) {
@@ -188,25 +193,23 @@ SocketReader::run()
 		}
 
 		// Build an LV2_Atom at chunk.buf from the message
-		forge.read(*world, model, _msg_node);
+		forge.read(world, model, _msg_node);
 
 		// Call _iface methods based on atom content
 		ar.write(forge.atom());
 
 		// Reset everything for the next iteration
 		forge.clear();
-		sord_node_free(world->c_obj(), _msg_node);
+		sord_node_free(world.c_obj(), _msg_node);
 		_msg_node = nullptr;
 	}
 
-	// Lock RDF world
-	std::lock_guard<std::mutex> lock(_world.rdf_mutex());
-
 	// Destroy everything
 	sord_inserter_free(_inserter);
 	serd_reader_end_stream(reader);
 	serd_reader_free(reader);
 	sord_free(model);
+	sord_node_free(world.c_obj(), base_uri);
 	_socket.reset();
 }
 
@@ -17,10 +17,11 @@
 #include "ingen/SocketWriter.hpp"
 
 #include "ingen/URI.hpp"
+#include "ingen/URIs.hpp"
+#include "lv2/atom/atom.h"
 #include "raul/Socket.hpp"
 
-#include <boost/variant/get.hpp>
-
+#include <cstdint>
 #include <memory>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -37,18 +38,24 @@ SocketWriter::SocketWriter(URIMap&                       map,
                            const URI&                    uri,
                            std::shared_ptr<raul::Socket> sock)
 	: TurtleWriter(map, uris, uri)
+	, _uris(uris)
 	, _socket(std::move(sock))
 {}
 
-void
-SocketWriter::message(const Message& message)
+bool
+SocketWriter::write(const LV2_Atom* msg, int32_t default_id)
 {
-	TurtleWriter::message(message);
-	if (boost::get<BundleEnd>(&message)) {
+	const bool ret = TurtleWriter::write(msg, default_id);
+
+	const auto* obj = reinterpret_cast<const LV2_Atom_Object*>(msg);
+	if (msg->type == _uris.atom_Object &&
+	    obj->body.otype == _uris.ingen_BundleEnd) {
 		// Send a null byte to indicate end of bundle
 		const char end[] = { 0 };
 		send(_socket->fd(), end, 1, MSG_NOSIGNAL);
 	}
+
+	return ret;
 }
 
 size_t
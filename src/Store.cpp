@@ -43,38 +43,37 @@ Store::add(Node* o)
 }
 
 /*
-  TODO: These methods are currently O(n_children) but should logarithmic.  The
-  std::map methods do not allow passing a comparator, but std::upper_bound
-  does.  This should be achievable by making a rooted comparator that is a
-  normal ordering except compares a special sentinel value as the greatest
-  element that is a child of the parent.  Searching for this sentinel should
-  then find the end of the descendants in logarithmic time.
+  Paths are sorted as strings, and every character that may follow a '/' in a
+  path sorts after it, so the descendants of "/a" are exactly the paths in
+  ["/a/", "/a0"), which directly follow "/a" itself.  Searching for the
+  sentinel "/a0" therefore finds the end of the descendants in logarithmic
+  time.
 */
 
+static raul::Path
+descendants_end_key(const raul::Path& parent)
+{
+	return raul::Path(parent + '0');
+}
+
 Store::iterator
 Store::find_descendants_end(const iterator parent)
 {
-	iterator descendants_end = parent;
-	++descendants_end;
-	while (descendants_end != end() &&
-	       descendants_end->first.is_child_of(parent->first)) {
-		++descendants_end;
+	if (parent == end() || parent->first.is_root()) {
+		return end();
 	}
 
-	return descendants_end;
+	return lower_bound(descendants_end_key(parent->first));
 }
 
 Store::const_iterator
 Store::find_descendants_end(const const_iterator parent) const
 {
-	const_iterator descendants_end = parent;
-	++descendants_end;
-	while (descendants_end != end() &&
-	       descendants_end->first.is_child_of(parent->first)) {
-		++descendants_end;
+	if (parent == end() || parent->first.is_root()) {
+		return end();
 	}
 
-	return descendants_end;
+	return lower_bound(descendants_end_key(parent->first));
 }
 
 Store::const_range
@@ -22,14 +22,160 @@
 
 #include <cassert>
 #include <cstdint>
-#include <utility>
+#include <cstring>
 
 namespace ingen {
 
+constexpr size_t URIMap::segment_base;
+constexpr size_t URIMap::n_segments;
+
+/// FNV-1a hash of a C string, so lookups never need to construct a string
+static size_t
+hash_uri(const char* uri)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (const char* c = uri; *c; ++c) {
+		hash = (hash ^ static_cast<uint8_t>(*c)) * 1099511628211ULL;
+	}
+	return static_cast<size_t>(hash);
+}
+
+/// Return the segment that the URI at `index` is stored in, and its offset
+static size_t
+segment_index(size_t index, size_t base, size_t* offset)
+{
+	size_t segment = 0;
+	size_t first   = 0;
+	while (index >= first + (base << segment)) {
+		first += base << segment;
+		++segment;
+	}
+
+	*offset = index - first;
+	return segment;
+}
+
+URIMap::Table::Table(size_t size)
+	: mask(size - 1)
+	, slots(new std::atomic<LV2_URID>[size])
+{
+	assert(!(size & mask));
+	for (size_t i = 0; i < size; ++i) {
+		slots[i].store(0, std::memory_order_relaxed);
+	}
+}
+
 URIMap::URIMap(Log& log, LV2_URID_Map* map, LV2_URID_Unmap* unmap)
 	: _urid_map_feature(new URIDMapFeature(this, map, log))
 	, _urid_unmap_feature(new URIDUnmapFeature(this, unmap))
+	, _table(nullptr)
+	, _size(0)
 {
+	for (auto& segment : _segments) {
+		segment.store(nullptr, std::memory_order_relaxed);
+	}
+
+	_tables.emplace_back(new Table(4 * segment_base));
+	_table = _tables.back().get();
+}
+
+URIMap::~URIMap()
+{
+	for (auto& segment : _segments) {
+		delete[] segment.load();
+	}
+}
+
+const char*
+URIMap::string(LV2_URID urid) const
+{
+	if (urid == 0 || urid > _size.load(std::memory_order_acquire)) {
+		return nullptr;
+	}
+
+	size_t       offset  = 0;
+	const size_t segment = segment_index(urid - 1, segment_base, &offset);
+
+	return _segments[segment].load(std::memory_order_acquire)[offset];
+}
+
+LV2_URID
+URIMap::find(const Table& table, const char* uri, size_t hash) const
+{
+	for (size_t i = hash & table.mask;; i = (i + 1) & table.mask) {
+		const LV2_URID id = table.slots[i].load(std::memory_order_acquire);
+		if (!id || !strcmp(string(id), uri)) {
+			return id;
+		}
+	}
+}
+
+LV2_URID
+URIMap::intern(const char* uri)
+{
+	// Fast path: URI is already mapped, no locking or allocation
+	const size_t hash = hash_uri(uri);
+	if (const LV2_URID id =
+	        find(*_table.load(std::memory_order_acquire), uri, hash)) {
+		return id;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// Check again, another thread may have mapped it while we waited
+	Table* table = _table.load(std::memory_order_relaxed);
+	if (const LV2_URID id = find(*table, uri, hash)) {
+		return id;
+	}
+
+	// Allocate the segment for this URID if necessary
+	const LV2_URID id      = _size.load(std::memory_order_relaxed) + 1;
+	size_t         offset  = 0;
+	const size_t   segment = segment_index(id - 1, segment_base, &offset);
+	if (segment >= n_segments) {
+		return 0;
+	}
+
+	const char** strings = _segments[segment].load(std::memory_order_relaxed);
+	if (!strings) {
+		strings = new const char*[segment_base << segment];
+		_segments[segment].store(strings, std::memory_order_release);
+	}
+
+	// Copy URI to stable storage, which lives as long as the map
+	const size_t len = strlen(uri);
+	_strings.emplace_back(new char[len + 1]);
+	memcpy(_strings.back().get(), uri, len + 1);
+	strings[offset] = _strings.back().get();
+	_size.store(id, std::memory_order_release);
+
+	// Grow the table to keep it at most half full
+	if (2 * id > table->mask + 1) {
+		_tables.emplace_back(new Table(2 * (table->mask + 1)));
+		Table* const new_table = _tables.back().get();
+		for (LV2_URID i = 1; i < id; ++i) {
+			size_t s = hash_uri(string(i)) & new_table->mask;
+			while (new_table->slots[s].load(std::memory_order_relaxed)) {
+				s = (s + 1) & new_table->mask;
+			}
+			new_table->slots[s].store(i, std::memory_order_relaxed);
+		}
+
+		/* Readers may still be using the old table, so it is kept until the
+		   map is destroyed.  They may miss this URI, but then fall back to
+		   the locked path and find it there. */
+		_table.store(new_table, std::memory_order_release);
+		table = new_table;
+	}
+
+	// Publish URID to readers, after its string is visible
+	size_t s = hash & table->mask;
+	while (table->slots[s].load(std::memory_order_relaxed)) {
+		s = (s + 1) & table->mask;
+	}
+	table->slots[s].store(id, std::memory_order_release);
+
+	return id;
 }
 
 URIMap::URIDMapFeature::URIDMapFeature(URIMap*       map,
@@ -51,18 +197,7 @@ LV2_URID
 URIMap::URIDMapFeature::default_map(LV2_URID_Map_Handle h,
                                     const char*         c_uri)
 {
-	auto* const                 map(static_cast<URIMap*>(h));
-	std::string                 uri(c_uri);
-	std::lock_guard<std::mutex> lock(map->_mutex);
-
-	auto       record = map->_map.emplace(uri, map->_map.size() + 1);
-	const auto id     = record.first->second;
-	if (record.second) {
-		assert(id == map->_map.size());
-		assert(id == map->_unmap.size() + 1);
-		map->_unmap.emplace_back(std::move(uri));
-	}
-	return id;
+	return static_cast<URIMap*>(h)->intern(c_uri);
 }
 
 LV2_URID
@@ -93,12 +228,7 @@ const char*
 URIMap::URIDUnmapFeature::default_unmap(LV2_URID_Unmap_Handle h,
                                         LV2_URID              urid)
 {
-	auto* const                 map(static_cast<URIMap*>(h));
-	std::lock_guard<std::mutex> lock(map->_mutex);
-
-	return (urid > 0 && urid <= map->_unmap.size()
-	        ? map->_unmap[urid - 1].c_str()
-	        : nullptr);
+	return static_cast<URIMap*>(h)->string(urid);
 }
 
 const char*
@@ -94,27 +94,50 @@ URIs::URIs(Forge& ingen_forge, URIMap* map, LilvWorld* lworld)
 	, ingen_activity        (forge, map, lworld, INGEN__activity)
 	, ingen_arc             (forge, map, lworld, INGEN__arc)
 	, ingen_block           (forge, map, lworld, INGEN__block)
+	, ingen_blockLength     (forge, map, lworld, INGEN__blockLength)
 	, ingen_broadcast       (forge, map, lworld, INGEN__broadcast)
 	, ingen_canvasX         (forge, map, lworld, INGEN__canvasX)
 	, ingen_canvasY         (forge, map, lworld, INGEN__canvasY)
+	, ingen_content         (forge, map, lworld, INGEN__content)
+	, ingen_continuation    (forge, map, lworld, INGEN__continuation)
+	, ingen_deadline        (forge, map, lworld, INGEN__deadline)
+	, ingen_degradation     (forge, map, lworld, INGEN__degradation)
+	, ingen_depth           (forge, map, lworld, INGEN__depth)
 	, ingen_enabled         (forge, map, lworld, INGEN__enabled)
+	, ingen_expendable      (forge, map, lworld, INGEN__expendable)
 	, ingen_externalContext (forge, map, lworld, INGEN__externalContext)
 	, ingen_file            (forge, map, lworld, INGEN__file)
 	, ingen_head            (forge, map, lworld, INGEN__head)
 	, ingen_incidentTo      (forge, map, lworld, INGEN__incidentTo)
 	, ingen_internalContext (forge, map, lworld, INGEN__internalContext)
+	, ingen_latency         (forge, map, lworld, INGEN__latency)
+	, ingen_limit           (forge, map, lworld, INGEN__limit)
 	, ingen_loadedBundle    (forge, map, lworld, INGEN__loadedBundle)
+	, ingen_maxQueueDepth   (forge, map, lworld, INGEN__maxQueueDepth)
 	, ingen_maxRunLoad      (forge, map, lworld, INGEN__maxRunLoad)
+	, ingen_maxRunTime      (forge, map, lworld, INGEN__maxRunTime)
+	, ingen_maxWorkLatency  (forge, map, lworld, INGEN__maxWorkLatency)
 	, ingen_meanRunLoad     (forge, map, lworld, INGEN__meanRunLoad)
+	, ingen_meanRunTime     (forge, map, lworld, INGEN__meanRunTime)
 	, ingen_minRunLoad      (forge, map, lworld, INGEN__minRunLoad)
 	, ingen_numThreads      (forge, map, lworld, INGEN__numThreads)
+	, ingen_offset          (forge, map, lworld, INGEN__offset)
 	, ingen_polyphonic      (forge, map, lworld, INGEN__polyphonic)
 	, ingen_polyphony       (forge, map, lworld, INGEN__polyphony)
+	, ingen_profile         (forge, map, lworld, INGEN__profile)
 	, ingen_prototype       (forge, map, lworld, INGEN__prototype)
+	, ingen_runCount        (forge, map, lworld, INGEN__runCount)
+	, ingen_runHistogram    (forge, map, lworld, INGEN__runHistogram)
+	, ingen_sharedInstance  (forge, map, lworld, INGEN__sharedInstance)
 	, ingen_sprungLayout    (forge, map, lworld, INGEN__sprungLayout)
+	, ingen_structure       (forge, map, lworld, INGEN__structure)
 	, ingen_tail            (forge, map, lworld, INGEN__tail)
 	, ingen_uiEmbedded      (forge, map, lworld, INGEN__uiEmbedded)
+	, ingen_undoMemory      (forge, map, lworld, INGEN__undoMemory)
 	, ingen_value           (forge, map, lworld, INGEN__value)
+	, ingen_values          (forge, map, lworld, INGEN__values)
+	, ingen_workCount       (forge, map, lworld, INGEN__workCount)
+	, ingen_workLatency     (forge, map, lworld, INGEN__workLatency)
 	, log_Error             (forge, map, lworld, LV2_LOG__Error)
 	, log_Note              (forge, map, lworld, LV2_LOG__Note)
 	, log_Trace             (forge, map, lworld, LV2_LOG__Trace)
@@ -58,6 +58,7 @@ class DummyInterface : public Interface
 };
 
 std::unique_ptr<World> world;
+volatile sig_atomic_t  write_trace_flag = 0;
 
 void
 ingen_interrupt(int signal)
@@ -73,6 +74,22 @@ ingen_interrupt(int signal)
 	}
 }
 
+void
+ingen_write_trace(int)
+{
+	write_trace_flag = 1;
+}
+
+void
+write_trace(const char* path)
+{
+	if (world->engine()->write_trace(FilePath(path))) {
+		std::cout << fmt("Wrote trace to %1%\n", path);
+	} else {
+		std::cerr << fmt("ingen: error: Failed to write trace to %1%\n", path);
+	}
+}
+
 void
 ingen_try(bool cond, const char* msg)
 {
@@ -162,7 +179,16 @@ run(int argc, char** argv)
 	}
 
 	// Activate the engine, if we have one
-	if (world->engine()) {
+	const bool render = conf.option("render").is_valid();
+	if (render && !world->engine()) {
+		std::cerr << "ingen: error: Rendering requires a local engine\n";
+		return EXIT_FAILURE;
+	} else if (render) {
+		if (!world->load_module("offline")) {
+			std::cerr << "ingen: error: Failed to load offline driver module\n";
+			return EXIT_FAILURE;
+		}
+	} else if (world->engine()) {
 		if (!world->load_module("jack") && !world->load_module("portaudio")) {
 			std::cerr << "ingen: error: Failed to load driver module\n";
 			return EXIT_FAILURE;
@@ -239,25 +265,46 @@ run(int argc, char** argv)
 	// Activate the engine now that the graph is loaded
 	if (world->engine()) {
 		world->engine()->flush_events(std::chrono::milliseconds(10));
-		world->engine()->activate();
+		ingen_try(world->engine()->activate(), "Failed to activate engine");
 	}
 
 	// Set up signal handlers that will set quit_flag on interrupt
 	signal(SIGINT, ingen_interrupt);
 	signal(SIGTERM, ingen_interrupt);
 
+	// Write a trace on SIGUSR1 if tracing
+	const char* const trace_path =
+		world->engine() && conf.option("trace-file").is_valid()
+		? conf.option("trace-file").ptr<char>()
+		: nullptr;
+#ifdef SIGUSR1
+	if (trace_path) {
+		signal(SIGUSR1, ingen_write_trace);
+	}
+#endif
+
 	if (conf.option("gui").get<int32_t>()) {
 		world->run_module("gui");
 	} else if (world->engine()) {
 		// Run engine main loop until interrupt
 		while (world->engine()->main_iteration()) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(125));
+			if (trace_path && write_trace_flag) {
+				write_trace_flag = 0;
+				write_trace(trace_path);
+			}
+			std::this_thread::sleep_for(
+				std::chrono::milliseconds(render ? 10 : 125));
 		}
 	}
 
 	// Sleep for a half second to allow event queues to drain
 	std::this_thread::sleep_for(std::chrono::milliseconds(500));
 
+	// Write the trace of the final moments before shutdown
+	if (trace_path) {
+		write_trace(trace_path);
+	}
+
 	// Shut down
 	if (world->engine()) {
 		world->engine()->deactivate();
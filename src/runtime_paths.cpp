@@ -156,6 +156,17 @@ user_data_dir()
 	return FilePath();
 }
 
+FilePath
+user_cache_dir()
+{
+	if (const char* xdg_cache_home = getenv("XDG_CACHE_HOME")) {
+		return FilePath(xdg_cache_home);
+	} else if (const char* home = getenv("HOME")) {
+		return FilePath(home) / ".cache";
+	}
+	return FilePath();
+}
+
 std::vector<FilePath>
 system_config_dirs()
 {
@@ -40,6 +40,7 @@ namespace server {
 ArcImpl::ArcImpl(PortImpl* tail, PortImpl* head)
 	: _tail(tail)
 	, _head(head)
+	, _delay(nullptr)
 {
 	assert(tail != head);
 	assert(tail->path() != head->path());
@@ -70,6 +71,10 @@ ArcImpl::head_path() const
 BufferRef
 ArcImpl::buffer(const RunContext&, uint32_t voice) const
 {
+	if (_delay) {
+		return (*_delay)[std::min(voice, uint32_t(_delay->size()) - 1)];
+	}
+
 	return _tail->buffer(std::min(voice, _tail->poly() - 1));
 }
 
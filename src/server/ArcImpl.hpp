@@ -27,6 +27,7 @@
 #include <boost/intrusive/slist_hook.hpp>
 
 #include <cstdint>
+#include <vector>
 
 namespace raul {
 class Path; // IWYU pragma: keep
@@ -76,11 +77,19 @@ public:
 	/** Whether this arc must mix down voices into a local buffer */
 	bool must_mix() const;
 
+	/** Read from delayed copies of the tail's buffers, or the tail if null.
+	 *
+	 * This is used by pipelined graphs to read output from a previous cycle.
+	 * Audio thread only.
+	 */
+	void set_delay(const std::vector<BufferRef>* buffers) { _delay = buffers; }
+
 	static bool can_connect(const PortImpl* src, const InputPort* dst);
 
 protected:
-	PortImpl* const _tail;
-	PortImpl* const _head;
+	PortImpl* const               _tail;
+	PortImpl* const               _head;
+	const std::vector<BufferRef>* _delay;
 };
 
 } // namespace server
@@ -18,14 +18,18 @@
 
 #include "InternalPlugin.hpp"
 #include "LV2Plugin.hpp"
+#include "PluginCache.hpp"
 #include "PluginImpl.hpp"
 #include "PortType.hpp"
 #include "ThreadManager.hpp"
 
 #include "ingen/LV2Features.hpp"
+#include "ingen/Configuration.hpp"
+#include "ingen/Forge.hpp"
 #include "ingen/Log.hpp"
 #include "ingen/URIs.hpp"
 #include "ingen/World.hpp"
+#include "ingen/runtime_paths.hpp"
 #include "internals/BlockDelay.hpp"
 #include "internals/Controller.hpp"
 #include "internals/Note.hpp"
@@ -41,13 +45,39 @@
 namespace ingen {
 namespace server {
 
+/** Set the version of a plugin from the cache, since it is not loaded. */
+static void
+set_cached_versions(World&                    world,
+                    PluginImpl&               plugin,
+                    const PluginCache::Entry& entry)
+{
+	if (entry.minor_version >= 0 && entry.micro_version >= 0) {
+		const URIs& uris = world.uris();
+		plugin.set_property(uris.lv2_minorVersion,
+		                    world.forge().make(entry.minor_version));
+		plugin.set_property(uris.lv2_microVersion,
+		                    world.forge().make(entry.micro_version));
+	}
+}
+
 BlockFactory::BlockFactory(ingen::World& world)
 	: _world(world)
 	, _has_loaded(false)
 {
 	load_internal_plugins();
+
+	const Atom&    use_cache = world.conf().option("plugin-cache");
+	const FilePath cache_dir = user_cache_dir();
+	if (use_cache.is_valid() && use_cache.get<int32_t>() &&
+	    !cache_dir.empty()) {
+		_cache = std::make_unique<PluginCache>(cache_dir / "ingen" /
+		                                       "plugins.cache");
+		_cache->load();
+	}
 }
 
+BlockFactory::~BlockFactory() = default;
+
 const BlockFactory::Plugins&
 BlockFactory::plugins()
 {
@@ -134,20 +164,87 @@ BlockFactory::load_plugin(const URI& uri)
 	LilvNode*          node  = lilv_new_uri(_world.lilv_world(), uri.c_str());
 	const LilvPlugins* plugs = lilv_world_get_all_plugins(_world.lilv_world());
 	const LilvPlugin*  plug  = lilv_plugins_get_by_uri(plugs, node);
-	if (plug) {
-		auto* const ingen_plugin = new LV2Plugin(_world, plug);
-		_plugins.emplace(uri, ingen_plugin);
-	}
 	lilv_node_free(node);
+	if (!plug) {
+		return;
+	}
+
+	// Skip plugins which are known to be unsupported without loading them
+	const PluginCache::Entry* const cached =
+	    _cache ? _cache->find(uri, PluginCache::stamp(plug)) : nullptr;
+	if (cached && !cached->supported) {
+		return;
+	}
+
+	auto* const ingen_plugin = new LV2Plugin(_world, plug);
+	if (cached) {
+		set_cached_versions(_world, *ingen_plugin, *cached);
+	}
+	_plugins.emplace(uri, ingen_plugin);
+}
+
+bool
+BlockFactory::is_supported(const LilvPlugin* lv2_plug, const Types& types)
+{
+	const URI uri(lilv_node_as_uri(lilv_plugin_get_uri(lv2_plug)));
+
+	// Ignore plugins that require features Ingen doesn't support
+	LilvNodes* features  = lilv_plugin_get_required_features(lv2_plug);
+	bool       supported = true;
+	LILV_FOREACH(nodes, f, features) {
+		const char* feature = lilv_node_as_uri(lilv_nodes_get(features, f));
+		if (!_world.lv2_features().is_supported(feature)) {
+			supported = false;
+			_world.log().warn("Ignoring <%1%>; required feature <%2%>\n",
+			                  uri, feature);
+			break;
+		}
+	}
+	lilv_nodes_free(features);
+	if (!supported) {
+		return false;
+	}
+
+	// Ignore plugins that are missing ports
+	if (!lilv_plugin_get_port_by_index(lv2_plug, 0)) {
+		_world.log().warn("Ignoring <%1%>; missing or corrupt ports\n", uri);
+		return false;
+	}
+
+	const uint32_t n_ports = lilv_plugin_get_num_ports(lv2_plug);
+	for (uint32_t p = 0; p < n_ports; ++p) {
+		const LilvPort* port = lilv_plugin_get_port_by_index(lv2_plug, p);
+		supported = false;
+		for (const auto& t : types) {
+			if (lilv_port_is_a(lv2_plug, port, t.get())) {
+				supported = true;
+				break;
+			}
+		}
+		if (!supported &&
+		    !lilv_port_has_property(lv2_plug,
+		                            port,
+		                            _world.uris().lv2_connectionOptional)) {
+			_world.log().warn("Ignoring <%1%>; unsupported port <%2%>\n",
+			                  uri,
+			                  lilv_node_as_string(
+				                  lilv_port_get_symbol(lv2_plug, port)));
+			return false;
+		}
+	}
+
+	return true;
 }
 
 /** Loads information about all LV2 plugins into internal plugin database.
+ *
+ * Plugins which have been checked on a previous run and have not changed
+ * since are taken from the cache, which avoids loading their data.
  */
 void
 BlockFactory::load_lv2_plugins()
 {
 	// Build an array of port type nodes for checking compatibility
-	using Types = std::vector<std::shared_ptr<LilvNode>>;
 	Types types;
 	for (unsigned t = PortType::ID::AUDIO; t <= PortType::ID::ATOM; ++t) {
 		const URI& uri(PortType(static_cast<PortType::ID>(t)).uri());
@@ -160,62 +257,47 @@ BlockFactory::load_lv2_plugins()
 		const LilvPlugin* lv2_plug = lilv_plugins_get(plugins, i);
 		const URI         uri(lilv_node_as_uri(lilv_plugin_get_uri(lv2_plug)));
 
-		// Ignore plugins that require features Ingen doesn't support
-		LilvNodes* features  = lilv_plugin_get_required_features(lv2_plug);
-		bool       supported = true;
-		LILV_FOREACH(nodes, f, features) {
-			const char* feature = lilv_node_as_uri(lilv_nodes_get(features, f));
-			if (!_world.lv2_features().is_supported(feature)) {
-				supported = false;
-				_world.log().warn("Ignoring <%1%>; required feature <%2%>\n",
-				                  uri, feature);
-				break;
+		const int64_t stamp = _cache ? PluginCache::stamp(lv2_plug) : 0;
+		const PluginCache::Entry* const cached =
+		    _cache ? _cache->find(uri, stamp) : nullptr;
+
+		PluginCache::Entry entry;
+		entry.stamp     = stamp;
+		entry.supported = cached ? cached->supported
+		                         : is_supported(lv2_plug, types);
+		if (!entry.supported) {
+			if (stamp && !cached) {
+				_cache->insert(uri, entry);
 			}
-		}
-		lilv_nodes_free(features);
-		if (!supported) {
-			continue;
-		}
-
-		// Ignore plugins that are missing ports
-		if (!lilv_plugin_get_port_by_index(lv2_plug, 0)) {
-			_world.log().warn("Ignoring <%1%>; missing or corrupt ports\n",
-			                  uri);
-			continue;
-		}
-
-		const uint32_t n_ports = lilv_plugin_get_num_ports(lv2_plug);
-		for (uint32_t p = 0; p < n_ports; ++p) {
-			const LilvPort* port = lilv_plugin_get_port_by_index(lv2_plug, p);
-			supported = false;
-			for (const auto& t : types) {
-				if (lilv_port_is_a(lv2_plug, port, t.get())) {
-					supported = true;
-					break;
-				}
-			}
-			if (!supported &&
-			    !lilv_port_has_property(lv2_plug,
-			                            port,
-			                            _world.uris().lv2_connectionOptional)) {
-				_world.log().warn("Ignoring <%1%>; unsupported port <%2%>\n",
-				                  uri,
-				                  lilv_node_as_string(
-					                  lilv_port_get_symbol(lv2_plug, port)));
-				break;
-			}
-		}
-		if (!supported) {
 			continue;
 		}
 
 		auto p = _plugins.find(uri);
 		if (p == _plugins.end()) {
 			auto* const plugin = new LV2Plugin(_world, lv2_plug);
-			_plugins.emplace(uri, plugin);
+			if (cached) {
+				set_cached_versions(_world, *plugin, *cached);
+			}
+			p = _plugins.emplace(uri, plugin).first;
 		} else if (lilv_plugin_verify(lv2_plug)) {
 			p->second->set_is_zombie(false);
 		}
+
+		if (stamp && !cached) {
+			const URIs& uris  = _world.uris();
+			const Atom& minor = p->second->get_property(uris.lv2_minorVersion);
+			const Atom& micro = p->second->get_property(uris.lv2_microVersion);
+			if (minor.type() == uris.forge.Int &&
+			    micro.type() == uris.forge.Int) {
+				entry.minor_version = minor.get<int32_t>();
+				entry.micro_version = micro.get<int32_t>();
+			}
+			_cache->insert(uri, entry);
+		}
+	}
+
+	if (_cache && !_cache->save()) {
+		_world.log().warn("Failed to write plugin cache\n");
 	}
 
 	_world.log().info("Loaded %1% plugins\n", _plugins.size());
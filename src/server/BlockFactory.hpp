@@ -18,11 +18,13 @@
 #define INGEN_ENGINE_BLOCKFACTORY_HPP
 
 #include "ingen/URI.hpp"
+#include "lilv/lilv.h"
 #include "raul/Noncopyable.hpp"
 
 #include <map>
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace ingen {
 
@@ -30,6 +32,7 @@ class World;
 
 namespace server {
 
+class PluginCache;
 class PluginImpl;
 
 /** Discovers and loads plugin libraries.
@@ -41,7 +44,7 @@ class BlockFactory : public raul::Noncopyable
 public:
 	explicit BlockFactory(ingen::World& world);
 
-	~BlockFactory() = default;
+	~BlockFactory();
 
 	/** Reload plugin list.
 	 *
@@ -57,12 +60,17 @@ public:
 	PluginImpl* plugin(const URI& uri);
 
 private:
+	using Types = std::vector<std::shared_ptr<LilvNode>>;
+
 	void load_lv2_plugins();
 	void load_internal_plugins();
 
-	Plugins       _plugins;
-	ingen::World& _world;
-	bool          _has_loaded;
+	bool is_supported(const LilvPlugin* lv2_plug, const Types& types);
+
+	Plugins                      _plugins;
+	ingen::World&                _world;
+	std::unique_ptr<PluginCache> _cache;
+	bool                         _has_loaded;
 };
 
 } // namespace server
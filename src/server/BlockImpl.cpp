@@ -17,12 +17,17 @@
 #include "BlockImpl.hpp"
 
 #include "Buffer.hpp"
+#include "Engine.hpp"
 #include "GraphImpl.hpp"
 #include "PluginImpl.hpp"
 #include "PortImpl.hpp"
+#include "Profiler.hpp"
 #include "RunContext.hpp"
 #include "ThreadManager.hpp"
 
+#include "ingen/Atom.hpp"
+#include "ingen/Forge.hpp"
+#include "ingen/URIs.hpp"
 #include "lv2/urid/urid.h"
 #include "raul/Array.hpp"
 #include "raul/Symbol.hpp"
@@ -47,6 +52,7 @@ BlockImpl::BlockImpl(PluginImpl*         plugin,
 	, _polyphonic(polyphonic)
 	, _activated(false)
 	, _enabled(true)
+	, _expendable(false)
 {
 	assert(_plugin);
 	assert(_polyphony > 0);
@@ -61,6 +67,36 @@ BlockImpl::~BlockImpl()
 	}
 }
 
+void
+BlockImpl::move_to(GraphImpl* parent, const raul::Symbol& symbol)
+{
+	assert(!is_linked());
+	assert(!_activated);
+
+	_parent = parent;
+	set_path(parent->path().child(symbol));
+	for (uint32_t p = 0; p < num_ports(); ++p) {
+		PortImpl* const port = _ports->at(p);
+		port->set_path(path().child(port->symbol()));
+	}
+}
+
+void
+BlockImpl::on_property(const URI& uri, const Atom& value)
+{
+	if (uri == uris().ingen_expendable && value.type() == uris().forge.Bool) {
+		_expendable = value.get<int32_t>();
+	}
+}
+
+void
+BlockImpl::on_property_removed(const URI& uri, const Atom&)
+{
+	if (uri == uris().ingen_expendable) {
+		_expendable = false;
+	}
+}
+
 Node*
 BlockImpl::port(uint32_t index) const
 {
@@ -229,23 +265,27 @@ BlockImpl::bypass(RunContext& ctx)
 void
 BlockImpl::process(RunContext& ctx)
 {
+	const ProfileScope profile(
+		ctx.profiler(), ctx.id(), ProfileSpan::Kind::BLOCK, this);
+
 	pre_process(ctx);
 
-	if (!_enabled) {
+	if (!_enabled ||
+	    (_expendable && ctx.engine().degraded(Engine::Degradation::BYPASS))) {
 		bypass(ctx);
 		post_process(ctx);
 		return;
 	}
 
-	RunContext subcontext(ctx);
-	for (SampleCount offset = 0; offset < ctx.nframes();) {
+	RunContext        subcontext(ctx);
+	const SampleCount end = ctx.offset() + ctx.nframes();
+	for (SampleCount offset = ctx.offset(); offset < end;) {
 		// Find earliest offset of a value change
-		SampleCount chunk_end = ctx.nframes();
+		SampleCount chunk_end = end;
 		for (uint32_t i = 0; _ports && i < _ports->size(); ++i) {
 			PortImpl* const port = _ports->at(i);
 			if (port->type() == PortType::CONTROL && port->is_input()) {
-				const SampleCount o = port->next_value_offset(
-					offset, ctx.nframes());
+				const SampleCount o = port->next_value_offset(offset, end);
 				if (o < chunk_end) {
 					chunk_end = o;
 				}
@@ -106,6 +106,9 @@ public:
 	/** Enable or disable (bypass) this block. */
 	void set_enabled(bool e) { _enabled = e; }
 
+	/** Return true iff this block may be bypassed when the engine is overloaded. */
+	bool expendable() const { return _expendable; }
+
 	/** Load a preset from the world for this block. */
 	virtual StatePtr load_preset(const URI& uri) { return {}; }
 
@@ -122,6 +125,9 @@ public:
 	/** Learn the next incoming MIDI event (for internals) */
 	virtual void learn() {}
 
+	/** Return run time statistics as properties (pre-process thread). */
+	virtual Properties statistics(const URIs& uris) const { return {}; }
+
 	/** Do whatever needs doing in the process thread before process() is called */
 	virtual void pre_process(RunContext& ctx);
 
@@ -191,6 +197,13 @@ public:
 		return reinterpret_cast<GraphImpl*>(_parent);
 	}
 
+	/** Move this unlinked block into a graph with a new symbol.
+	 *
+	 * This is used to place blocks which were instantiated in advance, the
+	 * block must not yet have been added to any graph.
+	 */
+	void move_to(GraphImpl* parent, const raul::Symbol& symbol);
+
 	uint32_t num_ports() const override { return _ports ? _ports->size() : 0; }
 
 	virtual uint32_t polyphony() const { return _polyphony; }
@@ -201,6 +214,9 @@ public:
 	void set_mark(Mark m) { _mark = m; }
 
 protected:
+	void on_property(const URI& uri, const Atom& value) override;
+	void on_property_removed(const URI& uri, const Atom& value) override;
+
 	PortImpl* nth_port_by_type(uint32_t n, bool input, PortType type);
 
 	PluginImpl*              _plugin;
@@ -212,6 +228,7 @@ protected:
 	bool                     _polyphonic;
 	bool                     _activated;
 	bool                     _enabled;
+	bool                     _expendable; ///< Bypass when overloaded
 };
 
 } // namespace server
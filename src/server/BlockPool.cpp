@@ -0,0 +1,146 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BlockPool.hpp"
+
+#include "BlockImpl.hpp"
+#include "Engine.hpp"
+#include "GraphImpl.hpp"
+#include "LV2Plugin.hpp"
+#include "PluginImpl.hpp"
+#include "ThreadManager.hpp"
+
+#include "ingen/Log.hpp"
+#include "raul/Symbol.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace ingen {
+namespace server {
+
+constexpr size_t BlockPool::max_plugins;
+
+BlockPool::BlockPool(Engine& engine, unsigned n_spares)
+	: _engine(engine)
+	, _n_spares(n_spares)
+	, _closed(false)
+{}
+
+BlockPool::~BlockPool() = default;
+
+BlockImpl*
+BlockPool::take(const PluginImpl&   plugin,
+                const raul::Symbol& symbol,
+                GraphImpl*          parent)
+{
+	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto s = std::find_if(_spares.begin(),
+	                      _spares.end(),
+	                      [&plugin](const Spares& spares) {
+		                      return spares.plugin == &plugin;
+	                      });
+
+	if (s == _spares.end() || s->blocks.empty()) {
+		return nullptr;
+	}
+
+	BlockImpl* const block = s->blocks.back().release();
+	s->blocks.pop_back();
+	block->move_to(parent, symbol);
+	return block;
+}
+
+void
+BlockPool::use(PluginImpl& plugin)
+{
+	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
+	if (!_n_spares || !dynamic_cast<LV2Plugin*>(&plugin)) {
+		return;  // Disabled, or an internal which is cheap to instantiate
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// Move spares for this plugin to the front, or add a new empty entry
+	auto s = std::find_if(_spares.begin(),
+	                      _spares.end(),
+	                      [&plugin](const Spares& spares) {
+		                      return spares.plugin == &plugin;
+	                      });
+	if (s != _spares.end()) {
+		Spares spares = std::move(*s);
+		_spares.erase(s);
+		_spares.emplace_front(std::move(spares));
+	} else {
+		_spares.emplace_front(Spares{&plugin, {}});
+	}
+
+	// Forget the least recently used plugin if there are too many
+	if (_spares.size() > max_plugins) {
+		_spares.pop_back();
+	}
+}
+
+bool
+BlockPool::refill()
+{
+	ThreadManager::assert_thread(THREAD_PRE_PROCESS);
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	GraphImpl* const root = _engine.root_graph();
+	if (_closed || !root) {
+		return false;
+	}
+
+	auto s = std::find_if(_spares.begin(),
+	                      _spares.end(),
+	                      [this](const Spares& spares) {
+		                      return spares.blocks.size() < _n_spares;
+	                      });
+	if (s == _spares.end()) {
+		return false;
+	}
+
+	// Instantiate in the root graph, the block is moved when it is taken
+	BlockImpl* const block = s->plugin->instantiate(*_engine.buffer_factory(),
+	                                                s->plugin->symbol(),
+	                                                false,
+	                                                root,
+	                                                _engine,
+	                                                nullptr);
+	if (!block) {
+		_engine.log().warn("Failed to instantiate spare <%1%>\n",
+		                   s->plugin->uri());
+		_spares.erase(s);
+		return true;
+	}
+
+	s->blocks.emplace_back(block);
+	return true;
+}
+
+void
+BlockPool::clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_spares.clear();
+	_closed = true;
+}
+
+} // namespace server
+} // namespace ingen
@@ -0,0 +1,107 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_BLOCKPOOL_HPP
+#define INGEN_ENGINE_BLOCKPOOL_HPP
+
+#include "raul/Noncopyable.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace raul {
+class Symbol;
+} // namespace raul
+
+namespace ingen {
+namespace server {
+
+class BlockImpl;
+class Engine;
+class GraphImpl;
+class PluginImpl;
+
+/** Spare instances of recently used plugins, instantiated in advance.
+ *
+ * Instantiating some plugins is slow, since they may allocate a lot of memory
+ * or load samples, and this holds up all events behind the one creating the
+ * block.  The pool keeps a few spare monophonic blocks with default state for
+ * the most recently used plugins, which are instantiated while the
+ * pre-processor is idle.  Creating a block can then take a spare instead,
+ * which only needs to be renamed.
+ *
+ * Spares are instantiated in the pre-processor thread, since neither lilv nor
+ * plugin instantiation may be called concurrently with the pre-processor.
+ *
+ * \ingroup engine
+ */
+class BlockPool : public raul::Noncopyable
+{
+public:
+	BlockPool(Engine& engine, unsigned n_spares);
+
+	~BlockPool();
+
+	/** Take a spare block for a plugin and move it into a graph.
+	 *
+	 * @return The block, or null if there are no spares for this plugin.
+	 */
+	BlockImpl* take(const PluginImpl&   plugin,
+	                const raul::Symbol& symbol,
+	                GraphImpl*          parent);
+
+	/** Note that a plugin has been used, so spares of it should be kept. */
+	void use(PluginImpl& plugin);
+
+	/** Instantiate a spare block if any are missing.
+	 *
+	 * This instantiates at most one block, so it can be called repeatedly
+	 * while there is nothing else to do without delaying events for long.
+	 *
+	 * @return True iff more spare blocks are needed.
+	 */
+	bool refill();
+
+	/** Destroy all spares and stop refilling, before the engine is freed. */
+	void clear();
+
+private:
+	using Blocks = std::vector<std::unique_ptr<BlockImpl>>;
+
+	/** Spare blocks for a plugin. */
+	struct Spares
+	{
+		PluginImpl* plugin;
+		Blocks      blocks;
+	};
+
+	/** Maximum number of plugins to keep spares for. */
+	static constexpr size_t max_plugins = 8;
+
+	Engine&            _engine;
+	std::mutex         _mutex;
+	std::deque<Spares> _spares;  ///< Most recently used first
+	const unsigned     _n_spares;
+	bool               _closed;
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_BLOCKPOOL_HPP
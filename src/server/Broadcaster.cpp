@@ -29,6 +29,10 @@
 namespace ingen {
 namespace server {
 
+Broadcaster::Broadcaster(URIMap& map, URIs& uris)
+	: _writer(map, uris, _fan_out)
+{}
+
 Broadcaster::~Broadcaster()
 {
 	std::lock_guard<std::mutex> lock(_clients_mutex);
@@ -42,7 +46,8 @@ void
 Broadcaster::register_client(const std::shared_ptr<Interface>& client)
 {
 	std::lock_guard<std::mutex> lock(_clients_mutex);
-	_clients.insert(client);
+	_clients.emplace(client, dynamic_cast<AtomSink*>(client.get()));
+	_fan_out.sinks.reserve(_clients.size());
 }
 
 /** Remove a client from the list of registered clients.
@@ -75,7 +80,28 @@ Broadcaster::send_plugins(const BlockFactory::Plugins& plugins)
 {
 	std::lock_guard<std::mutex> lock(_clients_mutex);
 	for (const auto& c : _clients) {
-		send_plugins_to(c.get(), plugins);
+		send_plugins_to(c.first.get(), plugins);
+	}
+}
+
+void
+Broadcaster::message(const Message& msg)
+{
+	std::lock_guard<std::mutex> lock(_clients_mutex);
+
+	_fan_out.sinks.clear();
+	for (const auto& c : _clients) {
+		if (c.first == _ignore_client) {
+			continue;
+		} else if (c.second) {
+			_fan_out.sinks.push_back(c.second);
+		} else {
+			c.first->message(msg);
+		}
+	}
+
+	if (!_fan_out.sinks.empty()) {
+		_writer.message(msg);
 	}
 }
 
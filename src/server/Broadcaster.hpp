@@ -19,15 +19,21 @@
 
 #include "BlockFactory.hpp"
 
+#include "ingen/AtomSink.hpp"
+#include "ingen/AtomWriter.hpp"
 #include "ingen/Interface.hpp"
 #include "ingen/Message.hpp"
 #include "ingen/URI.hpp"
+#include "lv2/atom/atom.h"
 #include "raul/Noncopyable.hpp"
 
 #include <atomic>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <vector>
 
 namespace ingen {
 namespace server {
@@ -37,12 +43,16 @@ namespace server {
  * This is an Interface that forwards all messages to all registered
  * clients (for updating all clients on state changes in the engine).
  *
+ * Clients which are also atom sinks, like socket writers, are sent the same
+ * atom which is forged once for each message, rather than each converting
+ * the message itself.
+ *
  * \ingroup engine
  */
 class Broadcaster : public Interface
 {
 public:
-	Broadcaster() = default;
+	Broadcaster(URIMap& map, URIs& uris);
 	~Broadcaster() override;
 
 	void register_client(const std::shared_ptr<Interface>& client);
@@ -96,24 +106,32 @@ public:
 	static void
 	send_plugins_to(Interface*, const BlockFactory::Plugins& plugins);
 
-	void message(const Message& msg) override {
-		std::lock_guard<std::mutex> lock(_clients_mutex);
-		for (const auto& c : _clients) {
-			if (c != _ignore_client) {
-				c->message(msg);
-			}
-		}
-	}
+	void message(const Message& msg) override;
 
 	URI uri() const override { return URI("ingen:/broadcaster"); }
 
 private:
 	friend class Transfer;
 
-	using Clients = std::set<std::shared_ptr<Interface>>;
+	/** Sink which passes each forged message to several atom sinks. */
+	struct FanOut : public AtomSink {
+		bool write(const LV2_Atom* msg, int32_t default_id) override {
+			for (AtomSink* sink : sinks) {
+				sink->write(msg, default_id);
+			}
+			return true;
+		}
+
+		std::vector<AtomSink*> sinks;
+	};
+
+	/// Map from client to its atom sink interface, or null
+	using Clients = std::map<std::shared_ptr<Interface>, AtomSink*>;
 
 	std::mutex                           _clients_mutex;
 	Clients                              _clients;
+	FanOut                               _fan_out;
+	AtomWriter                           _writer;
 	std::set<std::shared_ptr<Interface>> _broadcastees;
 	std::atomic<bool>                    _must_broadcast{false};
 	unsigned                             _bundle_depth{0};
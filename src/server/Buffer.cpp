@@ -160,7 +160,9 @@ Buffer::copy(const RunContext& ctx, const Buffer* src)
 	} else if (src->is_audio() && is_control()) {
 		samples()[0] = src->samples()[0];
 	} else if (src->is_control() && is_audio()) {
-		set_block(src->samples()[0], 0, ctx.nframes());
+		set_block(src->samples()[0],
+		          ctx.offset(),
+		          ctx.offset() + ctx.nframes());
 	} else if (src->is_sequence() && is_audio() &&
 	           src->value_type() == _factory.uris().atom_Float) {
 		render_sequence(ctx, src, false);
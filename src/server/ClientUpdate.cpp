@@ -53,8 +53,19 @@ ClientUpdate::put(const URI&        uri,
 void
 ClientUpdate::put_port(const PortImpl* port)
 {
-	const URIs& uris = port->bufs().uris();
-	if (port->is_a(PortType::CONTROL) || port->is_a(PortType::CV)) {
+	const URIs& uris      = port->bufs().uris();
+	const bool  has_value = (port->is_a(PortType::CONTROL) ||
+	                         port->is_a(PortType::CV));
+
+	if (content == Content::VALUES) {
+		if (has_value) {
+			put(port->uri(), {{uris.ingen_value, port->value()}});
+		}
+	} else if (content == Content::STRUCTURE) {
+		Properties props = port->properties();
+		props.erase(uris.ingen_value);
+		put(port->uri(), props);
+	} else if (has_value) {
 		Properties props = port->properties();
 		props.erase(uris.ingen_value);
 		props.emplace(uris.ingen_value, port->value());
@@ -73,40 +84,62 @@ ClientUpdate::put_block(const BlockImpl* block)
 	if (uris.ingen_Graph == plugin->type()) {
 		put_graph(static_cast<const GraphImpl*>(block));
 	} else {
-		put(block->uri(), block->properties());
+		if (content != Content::VALUES) {
+			put(block->uri(), block->properties());
+		}
 		for (size_t j = 0; j < block->num_ports(); ++j) {
 			put_port(block->port_impl(j));
 		}
 	}
 }
 
-void
-ClientUpdate::put_graph(const GraphImpl* graph)
+uint32_t
+ClientUpdate::put_graph(const GraphImpl* graph, uint32_t offset, uint32_t limit)
 {
-	put(graph->uri(),
-	    graph->properties(Resource::Graph::INTERNAL),
-	    Resource::Graph::INTERNAL);
-
-	put(graph->uri(),
-	    graph->properties(Resource::Graph::EXTERNAL),
-	    Resource::Graph::EXTERNAL);
+	if (offset == 0) {
+		if (content != Content::VALUES) {
+			put(graph->uri(),
+			    graph->properties(Resource::Graph::INTERNAL),
+			    Resource::Graph::INTERNAL);
+
+			put(graph->uri(),
+			    graph->properties(Resource::Graph::EXTERNAL),
+			    Resource::Graph::EXTERNAL);
+		}
 
-	// Enqueue blocks
-	for (const auto& b : graph->blocks()) {
-		put_block(&b);
+		// Enqueue ports
+		for (uint32_t i = 0; i < graph->num_ports_non_rt(); ++i) {
+			put_port(graph->port_impl(i));
+		}
 	}
 
-	// Enqueue ports
-	for (uint32_t i = 0; i < graph->num_ports_non_rt(); ++i) {
-		put_port(graph->port_impl(i));
+	if (depth >= 0 && _level >= depth) {
+		return 0;  // Contents are too deep
 	}
 
-	// Enqueue arcs
-	for (const auto& a : graph->arcs()) {
-		const auto    arc     = a.second;
-		const Connect connect = {arc->tail_path(), arc->head_path()};
-		connects.push_back(connect);
+	// Enqueue blocks in this page
+	uint32_t index = 0;
+	++_level;
+	for (const auto& b : graph->blocks()) {
+		if (limit && index >= offset + limit) {
+			--_level;
+			return index;  // More blocks in the next page
+		} else if (index++ >= offset) {
+			put_block(&b);
+		}
+	}
+	--_level;
+
+	// Enqueue arcs with the last page, once all blocks have been sent
+	if (content != Content::VALUES) {
+		for (const auto& a : graph->arcs()) {
+			const auto    arc     = a.second;
+			const Connect connect = {arc->tail_path(), arc->head_path()};
+			connects.push_back(connect);
+		}
 	}
+
+	return 0;
 }
 
 void
@@ -22,6 +22,7 @@
 #include "ingen/URI.hpp"
 #include "raul/Path.hpp"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -43,13 +44,31 @@ class PluginImpl;
  * post_process() to avoid the need to lock.
  */
 struct ClientUpdate {
+	/** What to include when putting graph objects. */
+	enum class Content {
+		ALL,        ///< Everything
+		STRUCTURE,  ///< Everything except port values
+		VALUES      ///< Only port values
+	};
+
 	void put(const URI&        uri,
 	         const Properties& props,
 	         Resource::Graph   ctx = Resource::Graph::DEFAULT);
 
 	void put_port(const PortImpl* port);
 	void put_block(const BlockImpl* block);
-	void put_graph(const GraphImpl* graph);
+	void put_graph(const GraphImpl* graph) { put_graph(graph, 0, 0); }
+
+	/** Put one page of a graph.
+	 *
+	 * At most `limit` blocks starting at `offset` are put, or all of them if
+	 * `limit` is zero.  The graph itself and its ports are only put with the
+	 * first page, and arcs only with the last, so every page can be applied
+	 * as soon as it is received.
+	 *
+	 * @return The offset of the next page, or zero if this is the last.
+	 */
+	uint32_t put_graph(const GraphImpl* graph, uint32_t offset, uint32_t limit);
 	void put_plugin(PluginImpl* plugin);
 	void put_preset(const URIs&        uris,
 	                const URI&         plugin,
@@ -74,6 +93,12 @@ struct ClientUpdate {
 	std::vector<URI>     dels;
 	std::vector<Put>     puts;
 	std::vector<Connect> connects;
+
+	Content content = Content::ALL;
+	int32_t depth   = -1;  ///< Levels of blocks to put, or -1 for all
+
+private:
+	int32_t _level = 0;  ///< Level of blocks currently being put
 };
 
 } // namespace server
@@ -16,15 +16,23 @@
 
 #include "CompiledGraph.hpp"
 
+#include "ArcImpl.hpp"
 #include "BlockImpl.hpp"
+#include "Buffer.hpp"
+#include "BufferFactory.hpp"
+#include "DuplexPort.hpp"
 #include "Engine.hpp"
 #include "GraphImpl.hpp"
+#include "InputPort.hpp"
+#include "PortImpl.hpp"
 #include "ThreadManager.hpp"
 
 #include "ingen/Atom.hpp"
 #include "ingen/ColorContext.hpp"
 #include "ingen/Configuration.hpp"
+#include "ingen/Forge.hpp"
 #include "ingen/Log.hpp"
+#include "ingen/URIs.hpp"
 #include "ingen/World.hpp"
 #include "raul/Maid.hpp"
 #include "raul/Path.hpp"
@@ -38,6 +46,7 @@
 #include <exception>
 #include <limits>
 #include <utility>
+#include <vector>
 
 namespace ingen {
 namespace server {
@@ -71,6 +80,11 @@ has_provider_with_many_dependants(const BlockImpl* n)
 
 CompiledGraph::CompiledGraph(GraphImpl* graph)
 	: _master(std::unique_ptr<Task>(new Task(Task::Mode::SEQUENTIAL)))
+	, _graph(graph)
+	, _n_stages(0)
+	, _latency(0)
+	, _has_event_arcs(false)
+	, _installed(false)
 {
 	compile_graph(graph);
 }
@@ -119,6 +133,60 @@ parallel_depth(const BlockImpl* block)
 	return 2 + min_provider_depth;
 }
 
+/** Return the deadline of every block that feeds a graph output with one.
+ *
+ * The deadline of a block is the earliest ingen:deadline of any graph output
+ * it feeds, directly or through other blocks.
+ */
+static std::map<const BlockImpl*, float>
+block_deadlines(GraphImpl& graph)
+{
+	const URIs& uris = graph.engine().world().uris();
+
+	// Start with the blocks connected to outputs with a deadline
+	std::vector<std::pair<const BlockImpl*, float>> pending;
+	for (const auto& a : graph.arcs()) {
+		const auto* const arc  = static_cast<const ArcImpl*>(a.second.get());
+		const Atom&       hint = arc->head()->get_property(uris.ingen_deadline);
+		if (arc->head()->parent() == &graph &&
+		    arc->tail()->parent() != &graph &&
+		    hint.type() == uris.forge.Float) {
+			pending.emplace_back(arc->tail()->parent_block(), hint.get<float>());
+		}
+	}
+
+	// Propagate deadlines back through providers, keeping the earliest
+	std::map<const BlockImpl*, float> deadlines;
+	while (!pending.empty()) {
+		const auto p = pending.back();
+		pending.pop_back();
+
+		const auto d = deadlines.find(p.first);
+		if (d == deadlines.end() || p.second < d->second) {
+			deadlines[p.first] = p.second;
+			for (const auto* provider : p.first->providers()) {
+				pending.emplace_back(provider, p.second);
+			}
+		}
+	}
+
+	return deadlines;
+}
+
+/** Return the deadline of a subgraph as a block in its parent, or 1. */
+static float
+inherited_deadline(GraphImpl& graph)
+{
+	GraphImpl* const parent = graph.parent_graph();
+	if (!parent) {
+		return 1.0f;
+	}
+
+	const auto deadlines = block_deadlines(*parent);
+	const auto d         = deadlines.find(&graph);
+	return (d != deadlines.end()) ? d->second : inherited_deadline(*parent);
+}
+
 void
 CompiledGraph::compile_graph(GraphImpl* graph)
 {
@@ -159,6 +227,34 @@ CompiledGraph::compile_graph(GraphImpl* graph)
 
 	_master = Task::simplify(std::move(_master));
 
+	// Events are timed relative to the whole cycle, so can not be sliced
+	const URIs& uris = graph->engine().world().uris();
+	for (const auto& a : graph->arcs()) {
+		const auto* const arc = static_cast<const ArcImpl*>(a.second.get());
+		if (arc->tail()->buffer_type() == uris.atom_Sequence) {
+			_has_event_arcs = true;
+			break;
+		}
+	}
+
+	if (graph->is_main()) {
+		const int32_t n_stages = graph->engine().world().conf().option(
+			"pipeline-stages").get<int32_t>();
+		if (n_stages > 1) {
+			pipeline(graph, unsigned(n_stages));
+		}
+	}
+
+	// Run blocks that feed outputs with the earliest deadlines first, where
+	// everything in a subgraph is due by the deadline of the subgraph itself
+	const auto  deadlines = block_deadlines(*graph);
+	const float inherited = inherited_deadline(*graph);
+	_master->prioritize([&deadlines, inherited](const BlockImpl* b) {
+		const auto d = deadlines.find(b);
+		return (d != deadlines.end()) ? std::min(d->second, inherited)
+		                              : inherited;
+	});
+
 	if (graph->engine().world().conf().option("trace").get<int32_t>()) {
 		ColorContext ctx(stderr, ColorContext::Color::YELLOW);
 		dump(graph->path());
@@ -266,10 +362,162 @@ CompiledGraph::compile_block(BlockImpl*            n,
 	}
 }
 
+void
+CompiledGraph::pipeline(GraphImpl* graph, unsigned n_stages)
+{
+	if (_master->mode() == Task::Mode::SEQUENTIAL && _master->size() > 1) {
+		_master   = Task::split(std::move(_master), n_stages);
+		_n_stages = unsigned(_master->size());
+		for (unsigned s = 0; s < _n_stages; ++s) {
+			_master->child(s).for_each_block([this, s](BlockImpl* b) {
+				_stages.emplace_back(b, s);
+			});
+		}
+	} else {
+		// Nothing to split, but arcs may still need to be reset in install()
+		_n_stages = 1;
+		_master->for_each_block([this](BlockImpl* b) {
+			_stages.emplace_back(b, 0U);
+		});
+	}
+
+	_latency = _n_stages - 1;
+	if (!_latency) {
+		return;
+	}
+
+	// Delay outputs that may be read by a later stage or graph output
+	for (const auto& s : _stages) {
+		for (uint32_t i = 0; i < s.first->num_ports(); ++i) {
+			const PortImpl* const port = s.first->port_impl(i);
+			if (port->is_output()) {
+				add_delay(port, s.second, _n_stages);
+			}
+		}
+	}
+
+	// Graph inputs are read by the first stage on the same cycle
+	for (const auto& port : graph->inputs()) {
+		add_delay(&port, 0, _n_stages);
+	}
+
+	_active.reserve(_delays.size());
+}
+
+void
+CompiledGraph::add_delay(const PortImpl* port, unsigned stage, unsigned n_stages)
+{
+	BufferFactory& bufs = *_graph->engine().buffer_factory();
+
+	Delay& delay = _delays[port];
+	delay.port   = port;
+	delay.stage  = stage;
+	delay.n_used = 0;
+	delay.taps.resize(n_stages - stage);
+	for (auto& tap : delay.taps) {
+		for (uint32_t v = 0; v < port->poly(); ++v) {
+			tap.push_back(bufs.get_buffer(
+				port->buffer_type(), port->value().type(), port->buffer_size()));
+			tap.back()->clear();
+		}
+	}
+}
+
+void
+CompiledGraph::delay_arc(ArcImpl& arc, unsigned stage, bool after)
+{
+	const auto d = _delays.find(arc.tail());
+	if (d == _delays.end() || stage <= d->second.stage) {
+		arc.set_delay(nullptr);  // Same stage, read output directly
+		return;
+	}
+
+	Delay&       delay = d->second;
+	const size_t index = stage - delay.stage - (after ? 0U : 1U);
+	arc.set_delay(&delay.taps[index]);
+	if (!delay.n_used) {
+		_active.push_back(&delay);
+	}
+	delay.n_used = std::max(delay.n_used, index + 1);
+}
+
+void
+CompiledGraph::take_delays(CompiledGraph& prev)
+{
+	if (_delays.empty() || _stages != prev._stages) {
+		return;
+	}
+
+	for (auto& d : _delays) {
+		const auto p = prev._delays.find(d.first);
+		if (p != prev._delays.end() &&
+		    p->second.stage == d.second.stage &&
+		    p->second.taps.size() == d.second.taps.size() &&
+		    p->second.taps.front().size() == d.second.taps.front().size()) {
+			// Inner vectors stay in place, so arcs may read them until install()
+			std::swap(d.second.taps, p->second.taps);
+		}
+	}
+}
+
+void
+CompiledGraph::install()
+{
+	// Point arcs from earlier stages at the delay for the stage difference
+	for (const auto& s : _stages) {
+		for (uint32_t i = 0; i < s.first->num_ports(); ++i) {
+			PortImpl* const port = s.first->port_impl(i);
+			if (port->is_input()) {
+				for (auto& arc : static_cast<InputPort*>(port)->arcs()) {
+					delay_arc(arc, s.second, false);
+				}
+			}
+		}
+	}
+
+	// Graph outputs are mixed after running, so after delays have advanced
+	for (uint32_t i = 0; i < _graph->num_ports(); ++i) {
+		PortImpl* const port = _graph->port_impl(i);
+		if (port->is_output()) {
+			for (auto& arc : static_cast<DuplexPort*>(port)->arcs()) {
+				delay_arc(arc, _n_stages - 1, true);
+			}
+		}
+	}
+
+	_installed = true;
+}
+
+void
+CompiledGraph::advance(RunContext& ctx)
+{
+	for (Delay* const d : _active) {
+		const uint32_t n_voices =
+			std::min(d->port->poly(), uint32_t(d->taps.front().size()));
+
+		for (uint32_t v = 0; v < n_voices; ++v) {
+			// Reuse the oldest buffer for the output of this cycle
+			for (size_t i = d->n_used - 1; i > 0; --i) {
+				std::swap(d->taps[i][v], d->taps[i - 1][v]);
+			}
+
+			d->taps[0][v]->copy(ctx, d->port->buffer(v).get());
+		}
+	}
+}
+
 void
 CompiledGraph::run(RunContext& ctx)
 {
+	if (_n_stages && !_installed) {
+		install();
+	}
+
 	_master->run(ctx);
+
+	if (!_active.empty()) {
+		advance(ctx);
+	}
 }
 
 void
@@ -17,21 +17,28 @@
 #ifndef INGEN_ENGINE_COMPILEDGRAPH_HPP
 #define INGEN_ENGINE_COMPILEDGRAPH_HPP
 
+#include "BufferRef.hpp"
 #include "Task.hpp"
 
 #include "raul/Maid.hpp"
 #include "raul/Noncopyable.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace ingen {
 namespace server {
 
+class ArcImpl;
 class BlockImpl;
 class GraphImpl;
+class PortImpl;
 class RunContext;
 
 /** A graph ``compiled'' into a quickly executable form.
@@ -39,6 +46,11 @@ class RunContext;
  * This is a flat sequence of nodes ordered such that the process thread can
  * execute the nodes in order and have nodes always executed before any of
  * their dependencies.
+ *
+ * The root graph may be pipelined, where the top-level sequence is split into
+ * stages that run in parallel on different cycles.  Each stage processes the
+ * output of the previous stage from the last cycle, which is read from delayed
+ * copies of the ports between them, so every stage adds a cycle of latency.
  */
 class CompiledGraph : public raul::Maid::Disposable
                     , public raul::Noncopyable
@@ -48,6 +60,21 @@ public:
 
 	void run(RunContext& ctx);
 
+	/** Take the contents of delays from `prev` if the stages are unchanged.
+	 *
+	 * This is called in the process thread when this replaces `prev`, so
+	 * recompiling a pipelined graph does not drop the audio in flight.
+	 */
+	void take_delays(CompiledGraph& prev);
+
+	/** Return the latency added by pipelining, in cycles. */
+	uint32_t latency() const { return _latency; }
+
+	/** Return true iff events flow between children, so runs can not be
+	 * sliced into shorter blocks.
+	 */
+	bool has_event_arcs() const { return _has_event_arcs; }
+
 private:
 	friend class raul::Maid;  ///< Allow make_managed to construct
 
@@ -70,7 +97,40 @@ private:
 	                      size_t           max_depth,
 	                      BlockSet&        k);
 
+	/** Delayed copies of the output of a port read by later stages.
+	 *
+	 * Element i of `taps` is the output from i + 1 cycles ago while the graph
+	 * is running, and from i cycles ago after it has run.
+	 */
+	struct Delay {
+		const PortImpl*                     port;
+		unsigned                            stage;
+		std::vector<std::vector<BufferRef>> taps;    ///< Buffers by age, voice
+		size_t                              n_used;  ///< Number of taps read
+	};
+
+	void pipeline(GraphImpl* graph, unsigned n_stages);
+
+	void add_delay(const PortImpl* port, unsigned stage, unsigned n_stages);
+
+	void delay_arc(ArcImpl& arc, unsigned stage, bool after);
+
+	void install();
+
+	void advance(RunContext& ctx);
+
+	using Stages = std::vector<std::pair<BlockImpl*, unsigned>>;
+	using Delays = std::map<const PortImpl*, Delay>;
+
 	std::unique_ptr<Task> _master;
+	GraphImpl*            _graph;
+	Stages                _stages;     ///< Stage of every block if pipelined
+	Delays                _delays;     ///< Delays for ports read by later stages
+	std::vector<Delay*>   _active;     ///< Delays read by some arc
+	unsigned              _n_stages;   ///< Number of pipeline stages, or 0
+	uint32_t              _latency;    ///< Latency in cycles
+	bool                  _has_event_arcs;  ///< True iff any arc has events
+	bool                  _installed;  ///< True once arcs read from delays
 };
 
 inline raul::managed_ptr<CompiledGraph>
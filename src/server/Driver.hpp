@@ -108,6 +108,9 @@ public:
 
 	/** Return the real-time priority of the audio thread, or -1. */
 	virtual int real_time_priority() = 0;
+
+	/** Tell the system that the latency of the engine has changed. */
+	virtual void latency_changed() {}
 };
 
 } // namespace server
@@ -241,6 +241,11 @@ DuplexPort::post_process(RunContext& ctx)
 		   (external perspective) is ready. */
 		InputPort::pre_process(ctx);
 		InputPort::pre_run(ctx);
+
+		if (_is_driver_port && _arcs.empty() && !_user_buffer) {
+			// Nothing was mixed into the external buffer, so silence it
+			_voices->at(0).buffer->clear();
+		}
 	}
 	monitor(ctx);
 }
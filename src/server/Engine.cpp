@@ -17,6 +17,7 @@
 #include "Engine.hpp"
 
 #include "BlockFactory.hpp"
+#include "BlockPool.hpp"
 #include "Broadcaster.hpp"
 #include "BufferFactory.hpp"
 #include "BufferRef.hpp"
@@ -31,7 +32,10 @@
 #include "PortImpl.hpp"
 #include "PostProcessor.hpp"
 #include "PreProcessor.hpp"
+#include "Profiler.hpp"
 #include "RunContext.hpp"
+#include "RunPool.hpp"
+#include "Snapshot.hpp"
 #include "Task.hpp"
 #include "ThreadManager.hpp"
 #include "UndoStack.hpp"
@@ -47,6 +51,7 @@
 #include "ingen/AtomReader.hpp"
 #include "ingen/ColorContext.hpp"
 #include "ingen/Configuration.hpp"
+#include "ingen/FilePath.hpp"
 #include "ingen/Forge.hpp"
 #include "ingen/Interface.hpp"
 #include "ingen/LV2Features.hpp"
@@ -58,6 +63,8 @@
 #include "ingen/URI.hpp"
 #include "ingen/URIs.hpp"
 #include "ingen/World.hpp"
+#include "ingen/filesystem.hpp"
+#include "ingen/paths.hpp"
 #include "lv2/buf-size/buf-size.h"
 #include "lv2/state/state.h"
 #include "raul/Maid.hpp"
@@ -80,18 +87,43 @@ namespace server {
 thread_local unsigned ThreadManager::flags(0);
 bool                  ThreadManager::single_threaded(true);
 
+/** Return the memory limit for each undo stack in bytes. */
+static size_t
+undo_memory(ingen::World& world)
+{
+	const int32_t mib = world.conf().option("undo-memory").get<int32_t>();
+	return mib > 0 ? size_t(mib) << 20U : 0U;
+}
+
 Engine::Engine(ingen::World& world)
 	: _world(world)
 	, _options(new LV2Options(world.uris()))
 	, _buffer_factory(new BufferFactory(*this, world.uris()))
 	, _maid(new raul::Maid)
-	, _worker(new Worker(world.log(), event_queue_size()))
+	// Work is done synchronously when rendering offline, for exact results
+	, _worker(new Worker(world.log(),
+	                     event_queue_size(),
+	                     world.conf().option("render").is_valid(),
+	                     world.conf().option("worker-threads").get<int32_t>(),
+	                     world.conf().option("worker-priority").get<int32_t>()))
 	, _sync_worker(new Worker(world.log(), event_queue_size(), true))
-	, _broadcaster(new Broadcaster())
+	, _broadcaster(new Broadcaster(world.uri_map(), world.uris()))
+	, _profiler(new Profiler(world.conf().option("threads").get<int32_t>(),
+	                         uint32_t(16 * event_queue_size()),
+	                         size_t(1) << 20U,
+	                         world.conf().option("profile").get<int32_t>(),
+	                         world.conf().option("trace-file").is_valid()))
+	, _run_pool(world.conf().option("shared-threads").get<int32_t>()
+	            ? RunPool::instance(unsigned(std::max(
+	                  world.conf().option("threads").get<int32_t>() - 1, 0)))
+	            : nullptr)
 	, _control_bindings(new ControlBindings(*this))
 	, _block_factory(new BlockFactory(world))
-	, _undo_stack(new UndoStack(world.uris(), world.uri_map()))
-	, _redo_stack(new UndoStack(world.uris(), world.uri_map()))
+	, _block_pool(new BlockPool(
+		*this,
+		unsigned(std::max(0, world.conf().option("warm-pool").get<int32_t>()))))
+	, _undo_stack(new UndoStack(world.uris(), world.uri_map(), undo_memory(world)))
+	, _redo_stack(new UndoStack(world.uris(), world.uri_map(), undo_memory(world)))
 	, _post_processor(new PostProcessor(*this))
 	, _pre_processor(new PreProcessor(*this))
 	, _event_writer(new EventWriter(*this))
@@ -100,10 +132,23 @@ Engine::Engine(ingen::World& world)
 		new AtomReader(world.uri_map(), world.uris(), world.log(), *_interface))
 	, _root_graph(nullptr)
 	, _cycle_start_time(0)
+	, _deadline(0)
+	, _latency(0)
+	, _reported_latency(0)
+	, _degradation(Degradation::NONE)
+	, _degradation_changes(new raul::RingBuffer(64 * sizeof(int32_t)))
+	, _degradation_cycles(0)
 	, _rand_engine(reinterpret_cast<uintptr_t>(this))
 	, _uniform_dist(0.0f, 1.0f)
+	, _snapshot_interval(
+		uint64_t(world.conf().option("snapshot-interval").get<int32_t>()) *
+		1000000U)
+	, _next_snapshot(0)
+	, _max_polyphony(uint32_t(
+		std::max(0, world.conf().option("max-polyphony").get<int32_t>())))
 	, _quit_flag(false)
 	, _reset_load_flag(false)
+	, _degrade(world.conf().option("degrade").get<int32_t>())
 	, _atomic_bundles(world.conf().option("atomic-bundles").get<int32_t>())
 	, _activated(false)
 {
@@ -115,8 +160,14 @@ Engine::Engine(ingen::World& world)
 		_notifications.emplace_back(
 			std::make_unique<raul::RingBuffer>(uint32_t(24 * event_queue_size())));
 		_run_contexts.emplace_back(
-			std::make_unique<RunContext>(
-				*this, _notifications.back().get(), unsigned(i), i > 0));
+			std::make_unique<RunContext>(*this,
+			                             _notifications.back().get(),
+			                             unsigned(i),
+			                             i > 0 && !_run_pool));
+	}
+
+	if (_run_pool) {
+		_run_pool->add(*this);
 	}
 
 	_world.lv2_features().add_feature(_worker->schedule_feature());
@@ -134,6 +185,18 @@ Engine::Engine(ingen::World& world)
 	    std::make_shared<LV2Features::EmptyFeature>(
 	        LV2_STATE__loadDefaultState));
 
+	const Atom& snapshot = world.conf().option("snapshot");
+	if (snapshot.is_valid() && _snapshot_interval) {
+		FilePath path(snapshot.ptr<char>());
+		if (path.extension() != FilePath(Snapshot::extension)) {
+			path += Snapshot::extension;
+		}
+		if (path.is_relative()) {
+			path = filesystem::current_path() / path;
+		}
+		_snapshot_uri = URI(path).string();
+	}
+
 	if (world.conf().option("dump").get<int32_t>()) {
 		_interface = std::make_shared<Tee>(
 			Tee::Sinks{
@@ -148,6 +211,7 @@ Engine::Engine(ingen::World& world)
 
 Engine::~Engine()
 {
+	_block_pool->clear();
 	_root_graph = nullptr;
 	Engine::deactivate();
 
@@ -164,7 +228,12 @@ Engine::~Engine()
 
 	_atom_interface.reset();
 
-	// Delete run contexts
+	// Stop shared threads from running tasks, then delete run contexts
+	if (_run_pool) {
+		_run_pool->remove(*this);
+		_run_pool.reset();
+	}
+
 	_quit_flag = true;
 	_tasks_available.notify_all();
 	for (const auto& thread_ctx : _run_contexts) {
@@ -236,6 +305,15 @@ Engine::flush_events(const std::chrono::milliseconds& sleep_ms)
 void
 Engine::emit_notifications(FrameTime end)
 {
+	if (_profiler->enabled()) {
+		_profiler->process();
+	}
+
+	const ProfileScope profile(*_profiler,
+	                           _profiler->main_thread(),
+	                           ProfileSpan::Kind::NOTIFY,
+	                           nullptr);
+
 	for (const auto& ctx : _run_contexts) {
 		ctx->emit_notifications(end);
 	}
@@ -265,7 +343,11 @@ Engine::wait_for_tasks()
 void
 Engine::signal_tasks_available()
 {
-	_tasks_available.notify_all();
+	if (_run_pool) {
+		_run_pool->signal_tasks_available();
+	} else {
+		_tasks_available.notify_all();
+	}
 }
 
 Task*
@@ -303,6 +385,13 @@ Engine::block_length() const
 	return _driver->block_length();
 }
 
+/** Return the latency added by pipelining the root graph in frames. */
+SampleCount
+Engine::latency() const
+{
+	return _latency.load(std::memory_order_relaxed);
+}
+
 size_t
 Engine::sequence_size() const
 {
@@ -324,14 +413,18 @@ Engine::quit()
 Properties
 Engine::load_properties() const
 {
-	const ingen::URIs& uris = _world.uris();
+	const ingen::URIs& uris        = _world.uris();
+	const int64_t      undo_memory = int64_t(_undo_stack->memory() +
+	                                         _redo_stack->memory());
 
 	return { { uris.ingen_meanRunLoad,
 		       uris.forge.make(floorf(_run_load.mean) / 100.0f) },
 		     { uris.ingen_minRunLoad,
 	           uris.forge.make(_run_load.min / 100.0f) },
 		     { uris.ingen_maxRunLoad,
-		       uris.forge.make(_run_load.max / 100.0f) } };
+		       uris.forge.make(_run_load.max / 100.0f) },
+		     { uris.ingen_undoMemory,
+		       Forge::alloc(sizeof(undo_memory), uris.forge.Long, &undo_memory) } };
 }
 
 bool
@@ -345,9 +438,47 @@ Engine::main_iteration()
 		_run_load.changed = false;
 	}
 
+	// Periodically write a snapshot, but not before anything has been loaded.
+	// This holds up the pre-processor while the graph is described, but the
+	// file itself is written later in this thread.
+	if (!_snapshot_uri.empty() && _root_graph) {
+		const uint64_t now = _clock.now_microseconds();
+		if (now >= _next_snapshot) {
+			if (_next_snapshot) {
+				_interface->copy(main_uri(), URI(_snapshot_uri));
+			}
+			_next_snapshot = now + _snapshot_interval;
+		}
+	}
+
+	// Report latency changes to the system and clients
+	const SampleCount latency = this->latency();
+	if (latency != _reported_latency) {
+		_reported_latency = latency;
+		_driver->latency_changed();
+		_broadcaster->set_property(URI("ingen:/engine"),
+		                           _world.uris().ingen_latency,
+		                           _world.forge().make(int32_t(latency)));
+	}
+
+	// Report every change of degradation level, not just the latest
+	int32_t level = 0;
+	while (_degradation_changes->read(sizeof(level), &level) == sizeof(level)) {
+		_broadcaster->set_property(URI("ingen:/engine"),
+		                           _world.uris().ingen_degradation,
+		                           _world.forge().make(level));
+	}
+
 	return !_quit_flag;
 }
 
+bool
+Engine::write_trace(const FilePath& path)
+{
+	_profiler->process();
+	return _profiler->write_trace(path.string());
+}
+
 void
 Engine::set_driver(const std::shared_ptr<Driver>& driver)
 {
@@ -357,6 +488,11 @@ Engine::set_driver(const std::shared_ptr<Driver>& driver)
 		ctx->set_rate(driver->sample_rate());
 	}
 
+	if (_run_pool && !_run_pool->set_priority(driver->real_time_priority())) {
+		_world.log().error(
+			"Failed to set real-time priority of shared run threads\n");
+	}
+
 	_buffer_factory->set_block_length(driver->block_length());
 	_options->set(sample_rate(),
 	              block_length(),
@@ -427,7 +563,10 @@ Engine::activate()
 		}
 	}
 
-	_driver->activate();
+	if (!_driver->activate()) {
+		return false;
+	}
+
 	_root_graph->enable();
 
 	ThreadManager::single_threaded = false;
@@ -456,6 +595,8 @@ Engine::run(uint32_t sample_count)
 {
 	RunContext& ctx = run_context();
 	_cycle_start_time = current_time();
+	_deadline.store(_cycle_start_time + ctx.duration(),
+	                std::memory_order_relaxed);
 
 	post_processor()->set_end_time(ctx.end());
 
@@ -463,6 +604,10 @@ Engine::run(uint32_t sample_count)
 	// (Aiming for jitter-free 1 block event latency, ideally)
 	const unsigned n_processed_events = process_events();
 
+	// Update latency, which may have changed if the root graph was recompiled
+	_latency.store(_root_graph ? _root_graph->latency() * block_length() : 0,
+	               std::memory_order_relaxed);
+
 	// Reset load if graph structure has changed
 	if (_reset_load_flag) {
 		_run_load        = Load();
@@ -485,12 +630,64 @@ Engine::run(uint32_t sample_count)
 
 	// Update load for this cycle
 	if (ctx.duration() > 0) {
-		_run_load.update(current_time() - _cycle_start_time, ctx.duration());
+		const uint64_t time = current_time() - _cycle_start_time;
+		_run_load.update(time, ctx.duration());
+		if (_degrade) {
+			update_degradation(time * 100 / ctx.duration());
+		}
 	}
 
 	return n_processed_events;
 }
 
+bool
+Engine::past_deadline(float fraction) const
+{
+	if (!_degrade) {
+		return false;
+	}
+
+	const uint64_t duration = deadline() - _cycle_start_time;
+	return current_time() > _cycle_start_time + uint64_t(fraction * duration);
+}
+
+void
+Engine::update_degradation(uint64_t load)
+{
+	static const uint64_t high_load      = 80;  // Percent to shed more work
+	static const uint64_t low_load       = 50;  // Percent to restore work
+	static const uint32_t degrade_cycles = 4;   // Cycles between degrading
+
+	// Restore work only after about a second of sustained headroom
+	const uint32_t restore_cycles = sample_rate() / block_length();
+
+	const Degradation level = _degradation.load(std::memory_order_relaxed);
+	Degradation       next  = level;
+
+	if (load >= high_load) {
+		if (level == Degradation::BYPASS) {
+			_degradation_cycles = 0;  // Nothing more to shed, and no headroom
+		} else if (++_degradation_cycles >= degrade_cycles) {
+			next = static_cast<Degradation>(static_cast<int>(level) + 1);
+		}
+	} else if (load >= low_load) {
+		_degradation_cycles = 0;  // Not enough headroom to restore yet
+	} else if (level > Degradation::NONE &&
+	           ++_degradation_cycles >= restore_cycles) {
+		next = static_cast<Degradation>(static_cast<int>(level) - 1);
+	}
+
+	if (next != level) {
+		_degradation.store(next, std::memory_order_relaxed);
+		_degradation_cycles = 0;
+
+		const auto report = static_cast<int32_t>(next);
+		if (_degradation_changes->write_space() >= sizeof(report)) {
+			_degradation_changes->write(sizeof(report), &report);
+		}
+	}
+}
+
 bool
 Engine::pending_events() const
 {
@@ -506,9 +703,14 @@ Engine::enqueue_event(Event* ev, Event::Mode mode)
 unsigned
 Engine::process_events()
 {
-	const size_t MAX_EVENTS_PER_CYCLE = run_context().nframes() / 8;
+	// While overloaded, execute only one event per cycle besides urgent
+	// events like control changes, which are cheap and would be audibly late
+	const bool   defer = degraded(Degradation::EVENTS);
+	const size_t MAX_EVENTS_PER_CYCLE =
+		defer ? 1 : run_context().nframes() / 8;
+
 	return _pre_processor->process(
-		run_context(), *_post_processor, MAX_EVENTS_PER_CYCLE);
+		run_context(), *_post_processor, MAX_EVENTS_PER_CYCLE, !defer);
 }
 
 unsigned
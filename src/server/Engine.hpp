@@ -26,6 +26,8 @@
 #include "ingen/Properties.hpp"
 #include "ingen/ingen.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
@@ -33,6 +35,7 @@
 #include <memory>
 #include <mutex>
 #include <random>
+#include <string>
 #include <vector>
 
 namespace raul {
@@ -43,6 +46,7 @@ class RingBuffer;
 namespace ingen {
 
 class AtomReader;
+class FilePath;
 class Interface;
 class Log;
 class Store;
@@ -51,6 +55,7 @@ class World;
 namespace server {
 
 class BlockFactory;
+class BlockPool;
 class Broadcaster;
 class BufferFactory;
 class ControlBindings;
@@ -60,7 +65,9 @@ class GraphImpl;
 class LV2Options;
 class PostProcessor;
 class PreProcessor;
+class Profiler;
 class RunContext;
+class RunPool;
 class SocketListener;
 class Task;
 class UndoStack;
@@ -95,6 +102,7 @@ public:
 	bool main_iteration() override;
 	void register_client(const std::shared_ptr<Interface>& client) override;
 	bool unregister_client(const std::shared_ptr<Interface>& client) override;
+	bool write_trace(const FilePath& path) override;
 
 	void listen() override;
 
@@ -121,9 +129,46 @@ public:
 	/** Return the current time in microseconds. */
 	uint64_t current_time() const;
 
+	/** Return the time the current cycle should finish by in microseconds.
+	 *
+	 * This is used to decide which engine to help first when threads are
+	 * shared with other engines, and is comparable to current_time().
+	 */
+	uint64_t deadline() const {
+		return _deadline.load(std::memory_order_relaxed);
+	}
+
+	/** Return true iff it is too late to finish work due by `fraction` of the
+	 * current cycle, so that expendable work should be skipped.
+	 *
+	 * This is always false unless shedding work is enabled.
+	 */
+	bool past_deadline(float fraction) const;
+
 	/** Reset the load statistics (when the expected DSP load changes). */
 	void reset_load();
 
+	/** Work shed when the engine is overloaded, in order of severity.
+	 *
+	 * Each level includes all the less severe ones.
+	 */
+	enum class Degradation {
+		NONE,     ///< Running normally
+		MONITOR,  ///< Reduced port monitoring rate
+		EVENTS,   ///< Deferring events to later cycles
+		BYPASS    ///< Bypassing blocks marked ingen:expendable
+	};
+
+	/** Return the current degradation level as an integer. */
+	int32_t degradation() const {
+		return static_cast<int32_t>(_degradation.load());
+	}
+
+	/** Return true iff work at `level` is currently being shed. */
+	inline bool degraded(Degradation level) const {
+		return _degradation.load(std::memory_order_relaxed) >= level;
+	}
+
 	/** Enqueue an event to be processed (non-realtime threads only). */
 	void enqueue_event(Event* ev, Event::Mode mode=Event::Mode::NORMAL);
 
@@ -140,11 +185,13 @@ public:
 	const std::shared_ptr<EventWriter>&     event_writer()     const { return _event_writer; }
 	const std::unique_ptr<AtomReader>&      atom_interface()   const { return _atom_interface; }
     const std::unique_ptr<BlockFactory>&    block_factory()    const { return _block_factory; }
+    const std::unique_ptr<BlockPool>&       block_pool()       const { return _block_pool; }
     const std::unique_ptr<Broadcaster>&     broadcaster()      const { return _broadcaster; }
     const std::unique_ptr<BufferFactory>&   buffer_factory()   const { return _buffer_factory; }
     const std::unique_ptr<ControlBindings>& control_bindings() const { return _control_bindings; }
     const std::shared_ptr<Driver>&          driver()           const { return _driver; }
     const std::unique_ptr<PostProcessor>&   post_processor()   const { return _post_processor; }
+    const std::unique_ptr<Profiler>&        profiler()         const { return _profiler; }
     const std::unique_ptr<raul::Maid>&      maid()             const { return _maid; }
     const std::unique_ptr<UndoStack>&       undo_stack()       const { return _undo_stack; }
     const std::unique_ptr<UndoStack>&       redo_stack()       const { return _redo_stack; }
@@ -156,6 +203,9 @@ public:
 
 	RunContext& run_context() { return *_run_contexts[0]; }
 
+	/** Return the run context for thread `id`, where 0 is the main thread. */
+	RunContext& run_context(unsigned id) { return *_run_contexts[id]; }
+
 	void flush_events(const std::chrono::milliseconds& sleep_ms) override;
 	void advance(SampleCount nframes) override;
 	void locate(FrameTime s, SampleCount nframes) override;
@@ -170,6 +220,7 @@ public:
 
 	SampleRate  sample_rate() const;
 	SampleCount block_length() const;
+	SampleCount latency() const;
 	size_t      sequence_size() const;
 	size_t      event_queue_size() const;
 
@@ -177,9 +228,20 @@ public:
 	bool   atomic_bundles() const { return _atomic_bundles; }
 	bool   activated()      const { return _activated; }
 
+	/** Return the number of voices to allocate for a polyphony.
+	 *
+	 * This is at least `poly`, but may be more so that later increases up to
+	 * the configured maximum polyphony do not need to allocate anything.
+	 */
+	uint32_t voice_capacity(uint32_t poly) const {
+		return std::max(poly, _max_polyphony);
+	}
+
 	Properties load_properties() const;
 
 private:
+	void update_degradation(uint64_t load);
+
 	ingen::World& _world;
 
 	std::shared_ptr<LV2Options>      _options;
@@ -189,8 +251,11 @@ private:
 	std::unique_ptr<Worker>          _worker;
 	std::unique_ptr<Worker>          _sync_worker;
 	std::unique_ptr<Broadcaster>     _broadcaster;
+	std::unique_ptr<Profiler>        _profiler;
+	std::shared_ptr<RunPool>         _run_pool;
 	std::unique_ptr<ControlBindings> _control_bindings;
 	std::unique_ptr<BlockFactory>    _block_factory;
+	std::unique_ptr<BlockPool>       _block_pool;
 	std::unique_ptr<UndoStack>       _undo_stack;
 	std::unique_ptr<UndoStack>       _redo_stack;
 	std::unique_ptr<PostProcessor>   _post_processor;
@@ -204,8 +269,14 @@ private:
 	std::vector<std::unique_ptr<raul::RingBuffer>> _notifications;
 	std::vector<std::unique_ptr<RunContext>>       _run_contexts;
 	uint64_t                                       _cycle_start_time;
+	std::atomic<uint64_t>                          _deadline;
+	std::atomic<SampleCount>                       _latency;
+	SampleCount                                    _reported_latency;
 	Load                                           _run_load;
 	Clock                                          _clock;
+	std::atomic<Degradation>                       _degradation;
+	std::unique_ptr<raul::RingBuffer>              _degradation_changes;
+	uint32_t                                       _degradation_cycles;
 
 	std::mt19937                          _rand_engine;
 	std::uniform_real_distribution<float> _uniform_dist;
@@ -213,8 +284,15 @@ private:
 	std::condition_variable _tasks_available;
 	std::mutex              _tasks_mutex;
 
+	std::string _snapshot_uri;       ///< Snapshot file URI, or empty
+	uint64_t    _snapshot_interval;  ///< Time between snapshots in microseconds
+	uint64_t    _next_snapshot;      ///< Time of next snapshot in microseconds
+
+	uint32_t _max_polyphony;  ///< Voices to allocate in advance, or 0
+
 	bool _quit_flag;
 	bool _reset_load_flag;
+	bool _degrade;
 	bool _atomic_bundles;
 	bool _activated;
 };
@@ -105,6 +105,12 @@ public:
 	/** Return the blocking behaviour of this event (after construction). */
 	virtual Execution get_execution() const { return Execution::NORMAL; }
 
+	/** Return true iff this event is a cheap and time critical change, like
+	 * setting a control value, which is not deferred while overloaded
+	 * (after pre-processing).
+	 */
+	virtual bool is_urgent() const { return false; }
+
 	/** Return undo mode of this event. */
 	Mode get_mode() const { return _mode; }
 
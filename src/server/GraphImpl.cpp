@@ -26,6 +26,7 @@
 #include "InputPort.hpp"
 #include "PluginImpl.hpp"
 #include "PortImpl.hpp"
+#include "RunContext.hpp"
 #include "ThreadManager.hpp"
 
 #include "ingen/Forge.hpp"
@@ -37,6 +38,7 @@
 #include "raul/Maid.hpp"
 #include "raul/Symbol.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <map>
@@ -61,6 +63,8 @@ GraphImpl::GraphImpl(Engine&             engine,
 	, _engine(engine)
 	, _poly_pre(internal_poly)
 	, _poly_process(internal_poly)
+	, _block_length(0)
+	, _slice_length(0)
 	, _process(false)
 {
 	assert(internal_poly >= 1);
@@ -247,8 +251,69 @@ GraphImpl::process(RunContext& ctx)
 void
 GraphImpl::run(RunContext& ctx)
 {
-	if (_compiled_graph) {
+	if (!_compiled_graph) {
+		return;
+	}
+
+	const SampleCount block_length = this->block_length();
+	if (!block_length || has_event_ports() ||
+	    _compiled_graph->has_event_arcs()) {
+		// Not sliced, so slices are as long as those of the parent
+		const GraphImpl* const parent = parent_graph();
+		_slice_length = parent ? parent->slice_length() : _engine.block_length();
 		_compiled_graph->run(ctx);
+		return;
+	}
+
+	// Keep the slice length even for shorter runs so it never varies
+	_slice_length = block_length;
+	if (block_length >= ctx.nframes()) {
+		_compiled_graph->run(ctx);
+		return;
+	}
+
+	/* Run children in slices of the internal block length.  Tasks claimed by
+	   this copied context are not visible to other threads, so the slices are
+	   run entirely in this thread and never see a different context. */
+
+	RunContext        subcontext(ctx);
+	const SampleCount end = ctx.offset() + ctx.nframes();
+	for (SampleCount offset = ctx.offset(); offset < end;) {
+		const SampleCount nframes = std::min(block_length, end - offset);
+		subcontext.slice(offset, nframes);
+		_compiled_graph->run(subcontext);
+		offset += nframes;
+	}
+}
+
+bool
+GraphImpl::has_event_ports() const
+{
+	/* Events are timed relative to the whole cycle, so can not be sliced.
+	   Events between children are checked by the compiled graph. */
+	for (uint32_t i = 0; i < num_ports(); ++i) {
+		if (_ports->at(i)->buffer_type() == uris().atom_Sequence) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+GraphImpl::on_property(const URI& uri, const Atom& value)
+{
+	BlockImpl::on_property(uri, value);
+	if (uri == uris().ingen_blockLength && value.type() == uris().forge.Int) {
+		_block_length = std::max(0, value.get<int32_t>());
+	}
+}
+
+void
+GraphImpl::on_property_removed(const URI& uri, const Atom& value)
+{
+	BlockImpl::on_property_removed(uri, value);
+	if (uri == uris().ingen_blockLength) {
+		_block_length = 0;
 	}
 }
 
@@ -315,11 +380,20 @@ void
 GraphImpl::set_compiled_graph(raul::managed_ptr<CompiledGraph>&& cg)
 {
 	if (_compiled_graph && _compiled_graph != cg) {
+		if (cg) {
+			cg->take_delays(*_compiled_graph);
+		}
 		_engine.reset_load();
 	}
 	_compiled_graph = std::move(cg);
 }
 
+uint32_t
+GraphImpl::latency() const
+{
+	return _compiled_graph ? _compiled_graph->latency() : 0;
+}
+
 uint32_t
 GraphImpl::num_ports_non_rt() const
 {
@@ -28,6 +28,7 @@
 
 #include <boost/intrusive/slist.hpp>
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -140,6 +141,9 @@ public:
 	        boost::intrusive::slist<DuplexPort,
 	                                boost::intrusive::constant_time_size<true>>;
 
+	/** Return the inputs of this graph (pre-process thread only). */
+	const PortList& inputs() const { return _inputs; }
+
 	void add_input(DuplexPort& port) {
 		ThreadManager::assert_thread(THREAD_PRE_PROCESS);
 		assert(port.is_input());
@@ -186,6 +190,9 @@ public:
 	/** Set a new compiled graph to run, and return the old one. */
 	void set_compiled_graph(raul::managed_ptr<CompiledGraph>&& cg);
 
+	/** Return the latency added by pipelining, in cycles (process thread). */
+	uint32_t latency() const;
+
 	const raul::managed_ptr<Ports>& external_ports() { return _ports; }
 
 	void set_external_ports(raul::managed_ptr<Ports>&& pa) { _ports = std::move(pa); }
@@ -200,9 +207,29 @@ public:
 	uint32_t internal_poly()         const { return _poly_pre; }
 	uint32_t internal_poly_process() const { return _poly_process; }
 
+	/** Return the internal block length, or 0 to use the engine's. */
+	SampleCount block_length() const {
+		return _block_length.load(std::memory_order_relaxed);
+	}
+
+	/** Return the length of the slices children run in (process thread).
+	 *
+	 * This is the internal block length if the graph is sliced, or the slice
+	 * length of the parent graph (or the engine block length for the root)
+	 * otherwise, so it does not change with the length of each run.  The last
+	 * slice of a run may be shorter if the run is not a multiple of this.
+	 */
+	SampleCount slice_length() const { return _slice_length; }
+
 	Engine& engine() { return _engine; }
 
+protected:
+	void on_property(const URI& uri, const Atom& value) override;
+	void on_property_removed(const URI& uri, const Atom& value) override;
+
 private:
+	bool has_event_ports() const;
+
 	Engine&                          _engine;
 	uint32_t                         _poly_pre;     ///< Pre-process thread only
 	uint32_t                         _poly_process; ///< Process thread only
@@ -210,6 +237,8 @@ private:
 	PortList                         _inputs;  ///< Pre-process thread only
 	PortList                         _outputs; ///< Pre-process thread only
 	Blocks                           _blocks;  ///< Pre-process thread only
+	std::atomic<SampleCount>         _block_length; ///< Internal block length
+	SampleCount                      _slice_length; ///< Process thread only
 	bool                             _process; ///< True iff graph is enabled
 };
 
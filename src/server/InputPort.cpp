@@ -23,6 +23,7 @@
 #include "BufferRef.hpp"
 #include "GraphImpl.hpp"
 #include "NodeImpl.hpp"
+#include "Profiler.hpp"
 #include "RunContext.hpp"
 #include "mix.hpp"
 
@@ -132,12 +133,14 @@ void
 InputPort::add_arc(RunContext&, ArcImpl& c)
 {
 	_arcs.push_front(c);
+	c.tail()->add_dependant();
 }
 
 void
 InputPort::remove_arc(ArcImpl& arc)
 {
 	_arcs.erase(_arcs.iterator_to(arc));
+	arc.tail()->remove_dependant();
 }
 
 uint32_t
@@ -177,6 +180,9 @@ void
 InputPort::pre_run(RunContext& ctx)
 {
 	if ((_user_buffer || !_arcs.empty()) && !direct_connect()) {
+		const ProfileScope profile(
+			ctx.profiler(), ctx.id(), ProfileSpan::Kind::MIX, this);
+
 		const uint32_t src_poly   = max_tail_poly(ctx);
 		const uint32_t max_n_srcs = _arcs.size() * src_poly + 1;
 
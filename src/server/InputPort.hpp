@@ -129,6 +129,9 @@ public:
 
 	bool direct_connect() const;
 
+	/** Return the incoming arcs of this port (audio thread only). */
+	Arcs& arcs() { return _arcs; }
+
 protected:
 	bool get_buffers(BufferFactory&                   bufs,
 	                 PortImpl::GetFn                  get,
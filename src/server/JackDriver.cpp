@@ -49,11 +49,14 @@
 #include <jack/metadata.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <utility>
+#include <vector>
 
 using jack_sample_t = jack_default_audio_sample_t;
 
@@ -131,6 +134,7 @@ JackDriver::attach(const std::string& server_name,
 
 	jack_set_thread_init_callback(_client, thread_init_cb, this);
 	jack_set_buffer_size_callback(_client, block_length_cb, this);
+	jack_set_latency_callback(_client, latency_cb, this);
 
 	for (auto& p : _ports) {
 		register_port(p);
@@ -351,16 +355,22 @@ JackDriver::pre_process_port(RunContext& ctx, EnginePort* port)
 	Buffer*           graph_buf  = graph_port->buffer(0).get();
 	void*             jack_buf   = jack_port_get_buffer(jack_port, nframes);
 
+	port->set_buffer(jack_buf);
 	if (graph_port->is_a(PortType::AUDIO) || graph_port->is_a(PortType::CV)) {
+		// Outputs are silenced by the graph if nothing is mixed into them
 		graph_port->set_driver_buffer(jack_buf, nframes * sizeof(float));
 		if (graph_port->is_input()) {
 			graph_port->monitor(ctx);
-		} else {
-			graph_port->buffer(0)->clear(); // TODO: Avoid when possible
 		}
 	} else if (graph_port->buffer_type() == uris.atom_Sequence) {
 		graph_buf->prepare_write(ctx);
-		if (graph_port->is_input()) {
+
+		// Skip reading inputs that nothing reads from (except control bindings)
+		const bool read = graph_port->has_dependants() ||
+		                  graph_port == _engine.root_graph()->port_impl(0) ||
+		                  ctx.must_notify(graph_port);
+
+		if (graph_port->is_input() && read) {
 			// Copy events from Jack port buffer into graph port buffer
 			const jack_nframes_t event_count = jack_midi_get_event_count(jack_buf);
 			for (jack_nframes_t i = 0; i < event_count; ++i) {
@@ -390,9 +400,15 @@ JackDriver::post_process_port(RunContext& ctx, EnginePort* port) const
 			// First cycle for a new output, so pre_process wasn't called
 			jack_buf = jack_port_get_buffer(jack_port, nframes);
 			port->set_buffer(jack_buf);
+			if (graph_port->is_driver_port()) {
+				memset(jack_buf, 0, nframes * sizeof(float));
+			}
 		}
 
-		if (graph_port->buffer_type() == uris.atom_Sequence) {
+		if (graph_port->is_driver_port() && !_engine.root_graph()->enabled()) {
+			// Graph did not run to mix down output, so silence it
+			graph_port->buffer(0)->clear();
+		} else if (graph_port->buffer_type() == uris.atom_Sequence) {
 			// Copy LV2 MIDI events to Jack MIDI buffer
 			Buffer* const graph_buf = graph_port->buffer(0).get();
 			auto*         seq       = graph_buf->get<LV2_Atom_Sequence>();
@@ -410,7 +426,8 @@ JackDriver::post_process_port(RunContext& ctx, EnginePort* port) const
 		}
 	}
 
-	// Reset graph port buffer pointer to no longer point to the Jack buffer
+	// Reset buffer pointers to no longer point to the Jack buffer
+	port->set_buffer(nullptr);
 	if (graph_port->is_driver_port()) {
 		graph_port->set_driver_buffer(nullptr, 0);
 	}
@@ -545,5 +562,58 @@ JackDriver::_block_length_cb(jack_nframes_t nframes)
 	return 0;
 }
 
+void
+JackDriver::latency_changed()
+{
+	if (_client && _is_activated) {
+		jack_recompute_total_latencies(_client);
+	}
+}
+
+void
+JackDriver::_latency_cb(jack_latency_callback_mode_t mode)
+{
+	// Every output may depend on every input, so the latency of each output
+	// is the range of all input latencies plus ours, and vice versa.  Ports
+	// are found through Jack since _ports is owned by the process thread.
+	const char** const names = jack_get_ports(_client, nullptr, nullptr, 0);
+	if (!names) {
+		return;
+	}
+
+	const unsigned long from_flag = ((mode == JackCaptureLatency)
+	                                 ? JackPortIsInput
+	                                 : JackPortIsOutput);
+
+	std::vector<jack_port_t*> from;
+	std::vector<jack_port_t*> to;
+	for (const char** n = names; *n; ++n) {
+		jack_port_t* const port = jack_port_by_name(_client, *n);
+		if (port && jack_port_is_mine(_client, port)) {
+			if (jack_port_flags(port) & from_flag) {
+				from.push_back(port);
+			} else {
+				to.push_back(port);
+			}
+		}
+	}
+	jack_free(names);
+
+	jack_latency_range_t range{from.empty() ? 0U : UINT32_MAX, 0U};
+	for (jack_port_t* const port : from) {
+		jack_latency_range_t r{};
+		jack_port_get_latency_range(port, mode, &r);
+		range.min = std::min(range.min, r.min);
+		range.max = std::max(range.max, r.max);
+	}
+
+	const auto latency = jack_nframes_t(_engine.latency());
+	range.min += latency;
+	range.max += latency;
+	for (jack_port_t* const port : to) {
+		jack_port_set_latency_range(port, mode, &range);
+	}
+}
+
 } // namespace server
 } // namespace ingen
@@ -105,6 +105,8 @@ public:
 		return jack_client_real_time_priority(_client);
 	}
 
+	void latency_changed() override;
+
 	jack_client_t* jack_client()  const          { return _client; }
 	SampleCount    block_length() const override { return _block_length; }
 	size_t         seq_size()     const override { return _seq_size; }
@@ -131,6 +133,10 @@ private:
 	inline static int block_length_cb(jack_nframes_t nframes, void* const jack_driver) {
 		return static_cast<JackDriver*>(jack_driver)->_block_length_cb(nframes);
 	}
+	inline static void latency_cb(jack_latency_callback_mode_t mode,
+	                              void* const                  jack_driver) {
+		return static_cast<JackDriver*>(jack_driver)->_latency_cb(mode);
+	}
 
 	void pre_process_port(RunContext& ctx, EnginePort* port);
 	void post_process_port(RunContext& ctx, EnginePort* port) const;
@@ -143,6 +149,7 @@ private:
 	void _shutdown_cb();
 	int  _process_cb(jack_nframes_t nframes);
 	int  _block_length_cb(jack_nframes_t nframes);
+	void _latency_cb(jack_latency_callback_mode_t mode);
 
 protected:
 	using Ports = boost::intrusive::slist<EnginePort,
@@ -71,6 +71,7 @@ LV2Block::LV2Block(LV2Plugin*          plugin,
 	: BlockImpl(plugin, symbol, polyphonic, parent, srate)
 	, _lv2_plugin(plugin)
 	, _worker_iface(nullptr)
+	, _shared_instance(false)
 {
 	assert(_lv2_plugin);
 }
@@ -110,10 +111,7 @@ LV2Block::make_instance(URIs&      uris,
 	}
 
 	for (uint32_t p = 0; p < num_ports(); ++p) {
-		PortImpl* const port   = _ports->at(p);
-		Buffer* const   buffer = (preparing)
-			? port->prepared_buffer(voice).get()
-			: port->buffer(voice).get();
+		PortImpl* const port = _ports->at(p);
 		if (port->is_morph() && port->is_a(PortType::CV)) {
 			if (options_iface) {
 				const LV2_URID port_type = uris.lv2_CVPort;
@@ -125,16 +123,11 @@ LV2Block::make_instance(URIs&      uris,
 				options_iface->set(inst->lv2_handle, options);
 			}
 		}
+	}
 
-		if (buffer) {
-			if (port->is_a(PortType::CONTROL)) {
-				buffer->set_value(port->value());
-			} else if (port->is_a(PortType::CV)) {
-				buffer->set_block(port->value().get<float>(), 0, engine.block_length());
-			} else {
-				buffer->clear();
-			}
-		}
+	// Reset buffers, unless this replaces the instance of an existing voice
+	if (!preparing || voice >= _instances->size()) {
+		init_buffers(voice, preparing);
 	}
 
 	if (options_iface) {
@@ -172,6 +165,29 @@ LV2Block::make_instance(URIs&      uris,
 	return std::make_shared<Instance>(inst);
 }
 
+/** Reset the buffers of a voice to the current port values. */
+void
+LV2Block::init_buffers(uint32_t voice, bool preparing)
+{
+	const Engine& engine = parent_graph()->engine();
+	for (uint32_t p = 0; p < num_ports(); ++p) {
+		PortImpl* const port   = _ports->at(p);
+		Buffer* const   buffer = (preparing)
+			? port->prepared_buffer(voice).get()
+			: port->buffer(voice).get();
+
+		if (buffer) {
+			if (port->is_a(PortType::CONTROL)) {
+				buffer->set_value(port->value());
+			} else if (port->is_a(PortType::CV)) {
+				buffer->set_block(port->value().get<float>(), 0, engine.block_length());
+			} else {
+				buffer->clear();
+			}
+		}
+	}
+}
+
 bool
 LV2Block::prepare_poly(BufferFactory& bufs, uint32_t poly)
 {
@@ -181,15 +197,33 @@ LV2Block::prepare_poly(BufferFactory& bufs, uint32_t poly)
 
 	BlockImpl::prepare_poly(bufs, poly);
 
-	if (_polyphony == poly) {
+	// Instances are kept when polyphony decreases, so there may be enough
+	const uint32_t n_instances = _instances->size();
+	const bool     reshare =
+		n_instances > 1 && is_shared(1) != _shared_instance;
+
+	if (poly <= n_instances && !reshare) {
 		return true;
 	}
 
+	// Replace all but the first instance if sharing has changed
+	const uint32_t capacity =
+		std::max(n_instances, bufs.engine().voice_capacity(poly));
+	const uint32_t first = reshare ? 1 : n_instances;
+
 	const SampleRate rate = bufs.engine().sample_rate();
 	assert(!_prepared_instances);
 	_prepared_instances = bufs.maid().make_managed<Instances>(
-		poly, *_instances, nullptr);
-	for (uint32_t i = _polyphony; i < _prepared_instances->size(); ++i) {
+		capacity, *_instances, nullptr);
+	for (uint32_t i = first; i < _prepared_instances->size(); ++i) {
+		if (_shared_instance) {
+			_prepared_instances->at(i) = _prepared_instances->at(0);
+			if (i >= n_instances) {
+				init_buffers(i, true);
+			}
+			continue;
+		}
+
 		auto inst = make_instance(bufs.uris(), rate, i, true);
 		if (!inst) {
 			_prepared_instances.reset();
@@ -443,11 +477,25 @@ LV2Block::instantiate(BufferFactory& bufs, const LilvState* state)
 
 	_features = world.lv2_features().lv2_features(world, this);
 
+	// Share one instance between voices if the plugin data says it is safe
+	LilvNode* shared = lilv_world_get(world.lilv_world(),
+	                                  lilv_plugin_get_uri(plug),
+	                                  uris.ingen_sharedInstance,
+	                                  nullptr);
+	_shared_instance = lilv_node_is_bool(shared) && lilv_node_as_bool(shared);
+	lilv_node_free(shared);
+
 	// Actually create plugin instances and port buffers.
 	const SampleRate rate = bufs.engine().sample_rate();
 	_instances = bufs.maid().make_managed<Instances>(
 		_polyphony, nullptr);
 	for (uint32_t i = 0; i < _polyphony; ++i) {
+		if (i > 0 && _shared_instance) {
+			_instances->at(i) = _instances->at(0);
+			init_buffers(i, false);
+			continue;
+		}
+
 		_instances->at(i) = make_instance(bufs.uris(), rate, i, false);
 		if (!_instances->at(i)) {
 			return false;
@@ -558,8 +606,11 @@ LV2Block::activate(BufferFactory& bufs)
 {
 	BlockImpl::activate(bufs);
 
-	for (uint32_t i = 0; i < _polyphony; ++i) {
-		lilv_instance_activate(instance(i));
+	// Inactive voices are activated too, so they can be used again later
+	for (uint32_t i = 0; i < _instances->size(); ++i) {
+		if (!is_shared(i)) {
+			lilv_instance_activate(instance(i));
+		}
 	}
 }
 
@@ -568,8 +619,10 @@ LV2Block::deactivate()
 {
 	BlockImpl::deactivate();
 
-	for (uint32_t i = 0; i < _polyphony; ++i) {
-		lilv_instance_deactivate(instance(i));
+	for (uint32_t i = 0; i < _instances->size(); ++i) {
+		if (!is_shared(i)) {
+			lilv_instance_deactivate(instance(i));
+		}
 	}
 }
 
@@ -604,7 +657,20 @@ LV2Block::work(uint32_t size, const void* data)
 void
 LV2Block::run(RunContext& ctx)
 {
+	const bool shared = _polyphony > 1 && is_shared(1);
 	for (uint32_t i = 0; i < _polyphony; ++i) {
+		if (shared) {
+			// Connect the shared instance to the buffers of this voice
+			for (uint32_t p = 0; p < num_ports(); ++p) {
+				const PortImpl* const port = _ports->at(p);
+				const BufferRef&      buf  = port->buffer(i);
+				lilv_instance_connect_port(
+					instance(i),
+					p,
+					buf ? buf->port_data(port->type(), ctx.offset()) : nullptr);
+			}
+		}
+
 		lilv_instance_run(instance(i), ctx.nframes());
 	}
 }
@@ -680,8 +746,12 @@ LV2Block::apply_state(const std::unique_ptr<Worker>& worker,
 		state_features[0] = sched.get();
 	}
 
-	for (uint32_t v = 0; v < _polyphony; ++v) {
-		lilv_state_restore(state, instance(v), nullptr, nullptr, 0, state_features);
+	// Restore inactive voices too, so they match if they are used again
+	for (uint32_t v = 0; v < _instances->size(); ++v) {
+		if (!is_shared(v)) {
+			lilv_state_restore(
+				state, instance(v), nullptr, nullptr, 0, state_features);
+		}
 	}
 }
 
@@ -97,6 +97,13 @@ public:
 	                     const raul::Symbol& symbol,
 	                     GraphImpl*          parent) override;
 
+	/** Set whether all voices share one instance, which is run for each.
+	 *
+	 * This takes effect when instances are next prepared with prepare_poly(),
+	 * which replaces all but the first instance if sharing has changed.
+	 */
+	void set_shared_instance(bool shared) { _shared_instance = shared; }
+
 	bool prepare_poly(BufferFactory& bufs, uint32_t poly) override;
 	bool apply_poly(RunContext& ctx, uint32_t poly) override;
 
@@ -135,10 +142,17 @@ protected:
 	std::shared_ptr<Instance>
 	make_instance(URIs& uris, SampleRate rate, uint32_t voice, bool preparing);
 
+	void init_buffers(uint32_t voice, bool preparing);
+
 	inline LilvInstance* instance(uint32_t voice) {
 		return static_cast<LilvInstance*>((*_instances)[voice]->instance);
 	}
 
+	/** Return true iff a voice is run with the instance of the first. */
+	inline bool is_shared(uint32_t voice) const {
+		return voice > 0 && (*_instances)[voice] == (*_instances)[0];
+	}
+
 	using Instances = raul::Array<std::shared_ptr<Instance>>;
 
 	static void drop_instances(const raul::managed_ptr<Instances>& instances) {
@@ -183,6 +197,7 @@ protected:
 	std::mutex                                 _work_mutex;
 	Responses                                  _responses;
 	std::shared_ptr<LV2Features::FeatureArray> _features;
+	bool                                       _shared_instance;
 };
 
 } // namespace server
@@ -0,0 +1,942 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OfflineDriver.hpp"
+
+#include "Buffer.hpp"
+#include "BufferFactory.hpp"
+#include "BufferRef.hpp"
+#include "DuplexPort.hpp"
+#include "Engine.hpp"
+#include "PortType.hpp"
+#include "RunContext.hpp"
+#include "ThreadManager.hpp"
+
+#include "ingen/Atom.hpp"
+#include "ingen/Clock.hpp"
+#include "ingen/Configuration.hpp"
+#include "ingen/Log.hpp"
+#include "ingen/URIMap.hpp"
+#include "ingen/URIs.hpp"
+#include "ingen/World.hpp"
+#include "ingen/filesystem.hpp"
+#include "lv2/atom/atom.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/util.h"
+#include "raul/Path.hpp"
+#include "raul/Symbol.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace ingen {
+namespace server {
+
+class OfflineDriver::PortFile
+{
+public:
+	virtual ~PortFile() = default;
+
+	/** Return the length of the input in frames. */
+	virtual SampleCount length() const { return 0; }
+
+	/** Read input into, or prepare to write output from, a port. */
+	virtual void pre_process(RunContext& ctx, DuplexPort& port) = 0;
+
+	/** Write the output of a port. */
+	virtual void post_process(RunContext&, DuplexPort&) {}
+
+	/** Finish writing the file, returning false on error. */
+	virtual bool close() { return true; }
+};
+
+namespace {
+
+using FilePtr = std::unique_ptr<FILE, decltype(&fclose)>;
+
+inline uint16_t
+le16(const uint8_t* buf)
+{
+	return uint16_t(buf[0] | (buf[1] << 8U));
+}
+
+inline uint32_t
+le32(const uint8_t* buf)
+{
+	return (uint32_t(buf[0]) | (uint32_t(buf[1]) << 8U) |
+	        (uint32_t(buf[2]) << 16U) | (uint32_t(buf[3]) << 24U));
+}
+
+inline uint16_t
+be16(const uint8_t* buf)
+{
+	return uint16_t((buf[0] << 8U) | buf[1]);
+}
+
+inline uint32_t
+be32(const uint8_t* buf)
+{
+	return ((uint32_t(buf[0]) << 24U) | (uint32_t(buf[1]) << 16U) |
+	        (uint32_t(buf[2]) << 8U) | uint32_t(buf[3]));
+}
+
+void
+put_le16(std::vector<uint8_t>& buf, uint16_t value)
+{
+	buf.push_back(uint8_t(value & 0xFFU));
+	buf.push_back(uint8_t(value >> 8U));
+}
+
+void
+put_le32(std::vector<uint8_t>& buf, uint32_t value)
+{
+	put_le16(buf, uint16_t(value & 0xFFFFU));
+	put_le16(buf, uint16_t(value >> 16U));
+}
+
+void
+put_be32(std::vector<uint8_t>& buf, uint32_t value)
+{
+	for (int shift = 24; shift >= 0; shift -= 8) {
+		buf.push_back(uint8_t((value >> unsigned(shift)) & 0xFFU));
+	}
+}
+
+void
+put_varlen(std::vector<uint8_t>& buf, uint32_t value)
+{
+	uint8_t  bytes[5];
+	unsigned n = 0;
+	do {
+		bytes[n++] = value & 0x7FU;
+		value >>= 7U;
+	} while (value);
+
+	while (n > 1) {
+		buf.push_back(bytes[--n] | 0x80U);
+	}
+	buf.push_back(bytes[0]);
+}
+
+bool
+get_varlen(const uint8_t*& p, const uint8_t* end, uint32_t& value)
+{
+	value = 0;
+	for (unsigned i = 0; i < 4 && p < end; ++i) {
+		const uint8_t byte = *p++;
+		value = (value << 7U) | (byte & 0x7FU);
+		if (!(byte & 0x80U)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Audio */
+
+enum class SampleFormat { INT16, INT24, INT32, FLOAT32 };
+
+/** A mono input from the first channel of a PCM or float WAV file. */
+class AudioInput : public OfflineDriver::PortFile
+{
+public:
+	AudioInput(FilePtr file, SampleFormat format, uint32_t frame_size,
+	           SampleCount length, SampleCount block_length)
+		: _file(std::move(file))
+		, _format(format)
+		, _frame_size(frame_size)
+		, _remaining(length)
+		, _length(length)
+		, _raw(size_t(block_length) * frame_size)
+		, _buf(block_length)
+	{}
+
+	/** Open a WAV file and check that it has the expected sample rate. */
+	static std::unique_ptr<PortFile> open(Log&            log,
+	                                      const FilePath& path,
+	                                      SampleRate      rate,
+	                                      SampleCount     block_length);
+
+	SampleCount length() const override { return _length; }
+
+	void pre_process(RunContext& ctx, DuplexPort& port) override {
+		const SampleCount nframes = ctx.nframes();
+		const size_t      n       = fread(_raw.data(),
+		                                  _frame_size,
+		                                  std::min(nframes, _remaining),
+		                                  _file.get());
+
+		for (size_t i = 0; i < n; ++i) {
+			_buf[i] = sample(_raw.data() + i * _frame_size);
+		}
+		std::fill(_buf.begin() + n, _buf.begin() + nframes, 0.0f);
+		_remaining -= SampleCount(n);
+
+		port.set_driver_buffer(_buf.data(), nframes * sizeof(float));
+		port.monitor(ctx);
+	}
+
+	void post_process(RunContext&, DuplexPort& port) override {
+		port.set_driver_buffer(nullptr, 0);
+	}
+
+private:
+	float sample(const uint8_t* s) const {
+		switch (_format) {
+		case SampleFormat::INT16:
+			return int16_t(le16(s)) / 32768.0f;
+		case SampleFormat::INT24:
+			return (int32_t(uint32_t(s[0] << 8U) | uint32_t(s[1] << 16U) |
+			                (uint32_t(s[2]) << 24U)) /
+			        2147483648.0f);
+		case SampleFormat::INT32:
+			return int32_t(le32(s)) / 2147483648.0f;
+		case SampleFormat::FLOAT32:
+			break;
+		}
+
+		const uint32_t bits  = le32(s);
+		float          value = 0.0f;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	FilePtr              _file;
+	SampleFormat         _format;
+	uint32_t             _frame_size;
+	SampleCount          _remaining;
+	SampleCount          _length;
+	std::vector<uint8_t> _raw;
+	std::vector<float>   _buf;
+};
+
+std::unique_ptr<OfflineDriver::PortFile>
+AudioInput::open(Log&            log,
+                 const FilePath& path,
+                 SampleRate      rate,
+                 SampleCount     block_length)
+{
+	FilePtr file{fopen(path.c_str(), "rb"), &fclose};
+	if (!file) {
+		return nullptr;
+	}
+
+	uint8_t header[12];
+	if (fread(header, 1, sizeof(header), file.get()) != sizeof(header) ||
+	    memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4)) {
+		log.error("%1% is not a WAV file\n", path);
+		return nullptr;
+	}
+
+	// Find the format and data chunks
+	uint16_t format      = 0;
+	uint16_t n_channels  = 0;
+	uint32_t file_rate   = 0;
+	uint16_t frame_size  = 0;
+	uint16_t sample_bits = 0;
+	uint8_t  chunk[8];
+	while (fread(chunk, 1, sizeof(chunk), file.get()) == sizeof(chunk)) {
+		const uint32_t size = le32(chunk + 4);
+		if (!memcmp(chunk, "fmt ", 4)) {
+			uint8_t fmt[40]{};
+			if (size < 16 || size > sizeof(fmt) ||
+			    fread(fmt, 1, size, file.get()) != size) {
+				break;
+			}
+
+			format      = le16(fmt);
+			n_channels  = le16(fmt + 2);
+			file_rate   = le32(fmt + 4);
+			frame_size  = le16(fmt + 12);
+			sample_bits = le16(fmt + 14);
+			if (format == 0xFFFE && size >= 26) {
+				format = le16(fmt + 24);  // WAVE_FORMAT_EXTENSIBLE sub-format
+			}
+			if (size % 2) {
+				fseek(file.get(), 1, SEEK_CUR);
+			}
+		} else if (!memcmp(chunk, "data", 4)) {
+			SampleFormat sample_format = SampleFormat::FLOAT32;
+			if (format == 1 && sample_bits == 16) {
+				sample_format = SampleFormat::INT16;
+			} else if (format == 1 && sample_bits == 24) {
+				sample_format = SampleFormat::INT24;
+			} else if (format == 1 && sample_bits == 32) {
+				sample_format = SampleFormat::INT32;
+			} else if (format != 3 || sample_bits != 32) {
+				log.error("Unsupported sample format in %1%\n", path);
+				return nullptr;
+			}
+
+			if (!n_channels || frame_size < n_channels * sample_bits / 8) {
+				break;
+			} else if (file_rate != rate) {
+				log.error("%1% has sample rate %2%, not %3%\n",
+				          path, file_rate, rate);
+				return nullptr;
+			} else if (n_channels > 1) {
+				log.warn("Using only the first channel of %1%\n", path);
+			}
+
+			return std::unique_ptr<PortFile>(
+				new AudioInput(std::move(file),
+				               sample_format,
+				               frame_size,
+				               size / frame_size,
+				               block_length));
+		} else if (fseek(file.get(), long(size + size % 2), SEEK_CUR)) {
+			break;
+		}
+	}
+
+	log.error("Invalid WAV file %1%\n", path);
+	return nullptr;
+}
+
+/** A mono 32-bit float WAV output. */
+class AudioOutput : public OfflineDriver::PortFile
+{
+public:
+	AudioOutput(FilePtr file, SampleRate rate, SampleCount block_length)
+		: _file(std::move(file))
+		, _rate(rate)
+		, _n_frames(0)
+		, _buf(block_length)
+	{
+		write_header();
+	}
+
+	void pre_process(RunContext& ctx, DuplexPort& port) override {
+		port.set_driver_buffer(_buf.data(), ctx.nframes() * sizeof(float));
+		port.buffer(0)->clear();
+	}
+
+	void post_process(RunContext& ctx, DuplexPort& port) override {
+		const SampleCount nframes = ctx.nframes();
+
+		_raw.clear();
+		for (SampleCount i = 0; i < nframes; ++i) {
+			uint32_t bits = 0;
+			memcpy(&bits, &_buf[i], sizeof(bits));
+			put_le32(_raw, bits);
+		}
+
+		fwrite(_raw.data(), 1, _raw.size(), _file.get());
+		_n_frames += nframes;
+
+		port.set_driver_buffer(nullptr, 0);
+	}
+
+	bool close() override {
+		// Rewrite the header now that the length is known
+		rewind(_file.get());
+		write_header();
+		return !ferror(_file.get()) && !fclose(_file.release());
+	}
+
+private:
+	void write_header() {
+		const uint32_t data_size = _n_frames * sizeof(float);
+
+		_raw.clear();
+		_raw.insert(_raw.end(), {'R', 'I', 'F', 'F'});
+		put_le32(_raw, 50 + data_size);
+		_raw.insert(_raw.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+		put_le32(_raw, 18);
+		put_le16(_raw, 3);  // WAVE_FORMAT_IEEE_FLOAT
+		put_le16(_raw, 1);  // Channels
+		put_le32(_raw, _rate);
+		put_le32(_raw, _rate * sizeof(float));
+		put_le16(_raw, sizeof(float));
+		put_le16(_raw, 32);
+		put_le16(_raw, 0);
+		_raw.insert(_raw.end(), {'f', 'a', 'c', 't'});
+		put_le32(_raw, 4);
+		put_le32(_raw, _n_frames);
+		_raw.insert(_raw.end(), {'d', 'a', 't', 'a'});
+		put_le32(_raw, data_size);
+
+		fwrite(_raw.data(), 1, _raw.size(), _file.get());
+	}
+
+	FilePtr              _file;
+	SampleRate           _rate;
+	SampleCount          _n_frames;
+	std::vector<float>   _buf;
+	std::vector<uint8_t> _raw;
+};
+
+/* MIDI */
+
+struct MidiEvent
+{
+	uint64_t time;  ///< Time in ticks when reading, then in frames
+	uint8_t  size;
+	uint8_t  data[3];
+};
+
+/** Input of the channel events in a Standard MIDI File. */
+class MidiInput : public OfflineDriver::PortFile
+{
+public:
+	MidiInput(LV2_URID type, std::vector<MidiEvent> events)
+		: _events(std::move(events))
+		, _type(type)
+		, _next(0)
+	{}
+
+	static std::unique_ptr<PortFile> open(Log&            log,
+	                                      const URIs&     uris,
+	                                      const FilePath& path,
+	                                      SampleRate      rate);
+
+	SampleCount length() const override {
+		return _events.empty() ? 0 : SampleCount(_events.back().time + 1);
+	}
+
+	void pre_process(RunContext& ctx, DuplexPort& port) override {
+		Buffer* const buf = port.buffer(0).get();
+
+		buf->prepare_write(ctx);
+		for (; _next < _events.size() && _events[_next].time < ctx.end();
+		     ++_next) {
+			const MidiEvent& ev = _events[_next];
+			if (!buf->append_event(
+				    ev.time - ctx.start(), ev.size, _type, ev.data)) {
+				ctx.engine().log().rt_error("MIDI input overflow\n");
+			}
+		}
+		port.monitor(ctx);
+	}
+
+private:
+	std::vector<MidiEvent> _events;
+	LV2_URID               _type;
+	size_t                 _next;
+};
+
+std::unique_ptr<OfflineDriver::PortFile>
+MidiInput::open(Log&            log,
+                const URIs&     uris,
+                const FilePath& path,
+                SampleRate      rate)
+{
+	FilePtr file{fopen(path.c_str(), "rb"), &fclose};
+	if (!file) {
+		return nullptr;
+	}
+
+	std::vector<uint8_t> bytes;
+	uint8_t              block[4096];
+	for (size_t n = 0; (n = fread(block, 1, sizeof(block), file.get()));) {
+		bytes.insert(bytes.end(), block, block + n);
+	}
+
+	if (bytes.size() < 14 || memcmp(bytes.data(), "MThd", 4) ||
+	    be32(bytes.data() + 4) < 6) {
+		log.error("%1% is not a MIDI file\n", path);
+		return nullptr;
+	}
+
+	struct Tempo
+	{
+		uint64_t tick;
+		uint32_t usec_per_beat;
+	};
+
+	// Read channel events and tempo changes from every track
+	const uint16_t         division = be16(bytes.data() + 12);
+	std::vector<MidiEvent> events;
+	std::vector<Tempo>     tempos;
+	const uint8_t*         p   = bytes.data() + 8 + be32(bytes.data() + 4);
+	const uint8_t* const   end = bytes.data() + bytes.size();
+	while (end - p >= 8) {
+		const uint32_t chunk_size = be32(p + 4);
+		const uint8_t* t          = p + 8;
+		const uint8_t* t_end      = t + std::min(size_t(chunk_size),
+		                                         size_t(end - t));
+
+		const bool is_track = !memcmp(p, "MTrk", 4);
+		p = t_end;
+		if (!is_track) {
+			continue;
+		}
+
+		uint64_t tick   = 0;
+		uint8_t  status = 0;
+		uint32_t value  = 0;
+		while (t < t_end) {
+			if (!get_varlen(t, t_end, value) || t >= t_end) {
+				break;
+			}
+
+			tick += value;
+			if (*t == 0xFF) {
+				// Meta event
+				const uint8_t type = t + 1 < t_end ? t[1] : 0;
+				t += 2;
+				status = 0;
+				if (!get_varlen(t, t_end, value) || value > size_t(t_end - t)) {
+					break;
+				} else if (type == 0x51 && value == 3) {
+					tempos.push_back({tick, (uint32_t(t[0]) << 16U) |
+					                        (uint32_t(t[1]) << 8U) | t[2]});
+				}
+				t += value;
+			} else if (*t == 0xF0 || *t == 0xF7) {
+				// System exclusive, which is ignored
+				++t;
+				status = 0;
+				if (!get_varlen(t, t_end, value) || value > size_t(t_end - t)) {
+					break;
+				}
+				t += value;
+			} else {
+				if (*t & 0x80U) {
+					status = *t++;
+				} else if (!status) {
+					break;
+				}
+
+				const uint8_t type = status & 0xF0U;
+				const uint8_t size = (type == 0xC0 || type == 0xD0) ? 2 : 3;
+				if (size_t(t_end - t) < size_t(size - 1)) {
+					break;
+				}
+
+				MidiEvent ev{tick, size, {status, t[0], 0}};
+				if (size == 3) {
+					ev.data[2] = t[1];
+				}
+				events.push_back(ev);
+				t += size - 1;
+			}
+		}
+	}
+
+	// Convert times from ticks to frames
+	std::stable_sort(events.begin(), events.end(),
+	                 [](const MidiEvent& a, const MidiEvent& b) {
+		                 return a.time < b.time;
+	                 });
+	std::stable_sort(tempos.begin(), tempos.end(),
+	                 [](const Tempo& a, const Tempo& b) {
+		                 return a.tick < b.tick;
+	                 });
+
+	if (division & 0x8000U) {
+		// SMPTE time, in ticks per frame at some number of frames per second
+		const double ticks_per_second =
+			-int8_t(division >> 8U) * double(division & 0xFFU);
+
+		for (auto& ev : events) {
+			ev.time = uint64_t(llrint(ev.time / ticks_per_second * rate));
+		}
+	} else {
+		// Metrical time, in ticks per beat at a tempo which may change
+		const double ticks_per_beat = std::max(1U, unsigned(division));
+		double       seconds        = 0.0;
+		uint64_t     tempo_tick     = 0;
+		uint32_t     usec_per_beat  = 500000;
+		size_t       t              = 0;
+		for (auto& ev : events) {
+			for (; t < tempos.size() && tempos[t].tick <= ev.time; ++t) {
+				seconds += ((tempos[t].tick - tempo_tick) * usec_per_beat /
+				            ticks_per_beat / 1000000.0);
+				tempo_tick    = tempos[t].tick;
+				usec_per_beat = tempos[t].usec_per_beat;
+			}
+
+			const double time = seconds + ((ev.time - tempo_tick) *
+			                               usec_per_beat / ticks_per_beat /
+			                               1000000.0);
+
+			ev.time = uint64_t(llrint(time * rate));
+		}
+	}
+
+	return std::unique_ptr<PortFile>(
+		new MidiInput(uris.midi_MidiEvent, std::move(events)));
+}
+
+/** Output of MIDI events to a Standard MIDI File. */
+class MidiOutput : public OfflineDriver::PortFile
+{
+public:
+	static constexpr uint32_t ticks_per_beat = 960;
+	static constexpr uint32_t usec_per_beat  = 500000;
+
+	MidiOutput(FilePtr file, LV2_URID type, SampleRate rate)
+		: _file(std::move(file))
+		, _type(type)
+		, _rate(rate)
+		, _frames(0)
+		, _tick(0)
+	{
+		// Set the tempo so a tick is a fixed fraction of a second
+		_track.insert(_track.end(), {0x00, 0xFF, 0x51, 0x03});
+		_track.push_back(uint8_t(usec_per_beat >> 16U));
+		_track.push_back(uint8_t((usec_per_beat >> 8U) & 0xFFU));
+		_track.push_back(uint8_t(usec_per_beat & 0xFFU));
+	}
+
+	void pre_process(RunContext& ctx, DuplexPort& port) override {
+		port.buffer(0)->prepare_write(ctx);
+	}
+
+	void post_process(RunContext& ctx, DuplexPort& port) override {
+		const auto* seq = port.buffer(0)->get<LV2_Atom_Sequence>();
+
+		LV2_ATOM_SEQUENCE_FOREACH(seq, ev) {
+			const auto* const data =
+				static_cast<const uint8_t*>(LV2_ATOM_BODY_CONST(&ev->body));
+
+			if (ev->body.type != _type || !ev->body.size ||
+			    !(data[0] & 0x80U)) {
+				continue;
+			}
+
+			const double seconds = (_frames + ev->time.frames) / double(_rate);
+
+			const auto tick = uint64_t(
+				llrint(seconds * ticks_per_beat * 1000000.0 / usec_per_beat));
+
+			put_varlen(_track, uint32_t(std::max(tick, _tick) - _tick));
+			_tick = std::max(tick, _tick);
+
+			if (data[0] == 0xF0) {
+				_track.push_back(data[0]);
+				put_varlen(_track, ev->body.size - 1);
+				_track.insert(_track.end(), data + 1, data + ev->body.size);
+			} else {
+				_track.insert(_track.end(), data, data + ev->body.size);
+			}
+		}
+
+		_frames += ctx.nframes();
+	}
+
+	bool close() override {
+		_track.insert(_track.end(), {0x00, 0xFF, 0x2F, 0x00});
+
+		std::vector<uint8_t> header{'M', 'T', 'h', 'd'};
+		put_be32(header, 6);
+		header.insert(header.end(), {0x00, 0x00, 0x00, 0x01});  // Format 0
+		header.push_back(uint8_t(ticks_per_beat >> 8U));
+		header.push_back(uint8_t(ticks_per_beat & 0xFFU));
+		header.insert(header.end(), {'M', 'T', 'r', 'k'});
+		put_be32(header, uint32_t(_track.size()));
+
+		FILE* const file = _file.release();
+		const bool  ok =
+			(fwrite(header.data(), 1, header.size(), file) == header.size() &&
+			 fwrite(_track.data(), 1, _track.size(), file) == _track.size());
+
+		return !fclose(file) && ok;
+	}
+
+private:
+	FilePtr              _file;
+	LV2_URID             _type;
+	SampleRate           _rate;
+	uint64_t             _frames;
+	uint64_t             _tick;
+	std::vector<uint8_t> _track;
+};
+
+constexpr uint32_t MidiOutput::ticks_per_beat;
+constexpr uint32_t MidiOutput::usec_per_beat;
+
+} // namespace
+
+OfflineDriver::OfflineDriver(Engine&     engine,
+                             FilePath    input_dir,
+                             FilePath    output_dir,
+                             SampleRate  sample_rate,
+                             SampleCount length)
+	: _engine(engine)
+	, _forge()
+	, _input_dir(std::move(input_dir))
+	, _output_dir(std::move(output_dir))
+	, _sample_rate(sample_rate)
+	, _length(length)
+	, _block_length(engine.world().conf().option("buffer-size").get<int32_t>())
+	, _seq_size(std::max(size_t(4096U), size_t(_block_length) * 4U))
+	, _exit_flag(false)
+{
+	lv2_atom_forge_init(&_forge, &engine.world().uri_map().urid_map());
+}
+
+OfflineDriver::~OfflineDriver()
+{
+	deactivate();
+	_ports.clear_and_dispose([](EnginePort* p) { delete p; });
+}
+
+bool
+OfflineDriver::open_files()
+{
+	Log&        log  = _engine.log();
+	const URIs& uris = _engine.world().uris();
+
+	if (!filesystem::create_directories(_output_dir)) {
+		log.error("Failed to create directory %1%\n", _output_dir);
+		return false;
+	}
+
+	for (auto& p : _ports) {
+		const DuplexPort* const graph_port = p.graph_port();
+		const bool              is_audio   = (graph_port->is_a(PortType::AUDIO) ||
+		                                      graph_port->is_a(PortType::CV));
+
+		const std::string name =
+			graph_port->symbol() + (is_audio ? ".wav" : ".mid");
+
+		std::unique_ptr<PortFile> file;
+		if (graph_port->is_input()) {
+			if (_input_dir.empty()) {
+				continue;
+			}
+
+			const FilePath path = _input_dir / name;
+			if (!filesystem::exists(path)) {
+				log.warn("No input file %1%, input will be silent\n", path);
+				continue;
+			}
+
+			file = is_audio ? AudioInput::open(
+				                  log, path, _sample_rate, _block_length)
+			                : MidiInput::open(log, uris, path, _sample_rate);
+		} else {
+			const FilePath path = _output_dir / name;
+			FilePtr        out{fopen(path.c_str(), "wb"), &fclose};
+			if (!out) {
+				log.error("Failed to open %1% (%2%)\n", path, strerror(errno));
+				return false;
+			}
+
+			file = is_audio ? std::unique_ptr<PortFile>(new AudioOutput(
+				                  std::move(out), _sample_rate, _block_length))
+			                : std::unique_ptr<PortFile>(new MidiOutput(
+				                  std::move(out),
+				                  uris.midi_MidiEvent,
+				                  _sample_rate));
+		}
+
+		if (!file) {
+			return false;
+		}
+
+		p.set_handle(file.get());
+		_files.push_back(std::move(file));
+	}
+
+	return true;
+}
+
+bool
+OfflineDriver::close_files()
+{
+	bool ok = true;
+	for (auto& p : _ports) {
+		p.set_handle(nullptr);
+	}
+
+	for (auto& f : _files) {
+		ok = f->close() && ok;
+	}
+
+	_files.clear();
+	return ok;
+}
+
+bool
+OfflineDriver::activate()
+{
+	if (!open_files()) {
+		close_files();
+		return false;
+	}
+
+	if (!_length) {
+		// Render until the end of the longest input
+		for (const auto& f : _files) {
+			_length = std::max(_length, f->length());
+		}
+
+		if (!_length) {
+			_engine.log().error("Nothing to render, no inputs or length\n");
+			close_files();
+			return false;
+		}
+	}
+
+	_exit_flag = false;
+	_thread    = std::make_unique<std::thread>(&OfflineDriver::run, this);
+	return true;
+}
+
+void
+OfflineDriver::deactivate()
+{
+	if (_thread) {
+		_exit_flag = true;
+		_thread->join();
+		_thread.reset();
+	}
+
+	if (!close_files()) {
+		_engine.log().error("Failed to write output files\n");
+	}
+}
+
+void
+OfflineDriver::run()
+{
+	ThreadManager::set_flag(THREAD_PROCESS);
+
+	// The engine enables the root graph after activating the driver
+	while (!_engine.activated() && !_exit_flag) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	RunContext&    ctx     = _engine.run_context();
+	Clock          clock;
+	const uint64_t t_start = clock.now_microseconds();
+	SampleCount    offset  = 0;
+	while (offset < _length + _engine.latency() && !_exit_flag) {
+		// Render extra cycles at the end to flush a pipelined graph
+		const SampleCount nframes =
+			std::min(_block_length, _length + _engine.latency() - offset);
+
+		_engine.locate(offset, nframes);
+
+		// Read input
+		for (auto& p : _ports) {
+			if (p.handle()) {
+				static_cast<PortFile*>(p.handle())
+					->pre_process(ctx, *p.graph_port());
+			}
+		}
+
+		// Process
+		_engine.run(nframes);
+
+		// Write output, skipping the cycles of latency added by pipelining.
+		// The latency is only known after running, since the graph may have
+		// been compiled by events processed in this cycle.
+		const SampleCount latency = _engine.latency();
+		for (auto& p : _ports) {
+			if (p.handle() && offset >= latency) {
+				static_cast<PortFile*>(p.handle())
+					->post_process(ctx, *p.graph_port());
+			}
+		}
+
+		offset += nframes;
+	}
+
+	const double run_time    = (clock.now_microseconds() - t_start) / 1000000.0;
+	const double render_time = offset / double(_sample_rate);
+	_engine.log().info("Rendered %1% s in %2% s (%3%x real time)\n",
+	                   render_time,
+	                   run_time,
+	                   run_time > 0.0 ? render_time / run_time : 0.0);
+
+	_engine.quit();
+}
+
+SampleCount
+OfflineDriver::frame_time() const
+{
+	return _engine.run_context().start();
+}
+
+EnginePort*
+OfflineDriver::create_port(DuplexPort* graph_port)
+{
+	if (graph_port->is_a(PortType::AUDIO) || graph_port->is_a(PortType::CV)) {
+		auto* eport = new EnginePort(graph_port);
+		graph_port->set_is_driver_port(*_engine.buffer_factory());
+		return eport;
+	} else if (graph_port->is_a(PortType::ATOM) &&
+	           graph_port->buffer_type() ==
+	           _engine.world().uris().atom_Sequence) {
+		return new EnginePort(graph_port);
+	}
+
+	return nullptr;
+}
+
+EnginePort*
+OfflineDriver::get_port(const raul::Path& path)
+{
+	for (auto& p : _ports) {
+		if (p.graph_port()->path() == path) {
+			return &p;
+		}
+	}
+
+	return nullptr;
+}
+
+void
+OfflineDriver::add_port(RunContext&, EnginePort* port)
+{
+	_ports.push_back(*port);
+}
+
+void
+OfflineDriver::remove_port(RunContext&, EnginePort* port)
+{
+	_ports.erase(_ports.iterator_to(*port));
+}
+
+void
+OfflineDriver::append_time_events(RunContext& ctx, Buffer& buffer)
+{
+	if (ctx.start() != 0) {
+		return;  // Time only changes by rolling, so only the start is sent
+	}
+
+	const URIs&          uris = ctx.engine().world().uris();
+	LV2_Atom             pos_buf[8];
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_set_buffer(&_forge,
+	                          reinterpret_cast<uint8_t*>(pos_buf),
+	                          sizeof(pos_buf));
+
+	lv2_atom_forge_object(&_forge, &frame, 0, uris.time_Position);
+	lv2_atom_forge_key(&_forge, uris.time_frame);
+	lv2_atom_forge_long(&_forge, 0);
+	lv2_atom_forge_key(&_forge, uris.time_speed);
+	lv2_atom_forge_float(&_forge, 1.0f);
+
+	auto* lpos = static_cast<LV2_Atom*>(pos_buf);
+	buffer.append_event(0,
+	                    lpos->size,
+	                    lpos->type,
+	                    static_cast<const uint8_t*>(LV2_ATOM_BODY_CONST(lpos)));
+}
+
+} // namespace server
+} // namespace ingen
@@ -0,0 +1,146 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_OFFLINEDRIVER_HPP
+#define INGEN_ENGINE_OFFLINEDRIVER_HPP
+
+#include "Driver.hpp"
+#include "EnginePort.hpp" // IWYU pragma: keep
+#include "types.hpp"
+
+#include "ingen/FilePath.hpp"
+#include "ingen/URI.hpp"
+#include "lv2/atom/forge.h"
+
+#include <boost/intrusive/slist.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace raul { class Path; }
+
+namespace boost {
+namespace intrusive {
+
+template <bool Enabled>
+struct cache_last;
+
+} // namespace intrusive
+} // namespace boost
+
+namespace ingen {
+
+class Atom;
+
+namespace server {
+
+class Buffer;
+class DuplexPort;
+class Engine;
+class RunContext;
+
+/** Driver which renders the root graph offline, as fast as possible.
+ *
+ * Each root graph input is read from a file in the input directory named
+ * after the port symbol, "SYMBOL.wav" for audio and CV ports, or "SYMBOL.mid"
+ * for MIDI ports.  Inputs without a file are silent.  Outputs are written to
+ * files with the same names in the output directory.
+ *
+ * Rendering runs in its own thread from activation, and quits the engine
+ * when finished.
+ *
+ * \ingroup engine
+ */
+class OfflineDriver : public Driver
+{
+public:
+	/** A file read or written by a root port. */
+	class PortFile;
+
+	/** Create an offline driver.
+	 *
+	 * @param engine The engine to drive.
+	 * @param input_dir Directory of input files, or empty for none.
+	 * @param output_dir Directory to write output files to.
+	 * @param sample_rate Sample rate in Hz, which must be non-zero.
+	 * @param length Length to render in frames, or zero for the longest input.
+	 */
+	OfflineDriver(Engine&     engine,
+	              FilePath    input_dir,
+	              FilePath    output_dir,
+	              SampleRate  sample_rate,
+	              SampleCount length);
+
+	~OfflineDriver() override;
+
+	bool activate() override;
+	void deactivate() override;
+
+	EnginePort* create_port(DuplexPort* graph_port) override;
+	EnginePort* get_port(const raul::Path& path) override;
+
+	void rename_port(const raul::Path& old_path,
+	                 const raul::Path& new_path) override {}
+
+	void port_property(const raul::Path& path,
+	                   const URI&        uri,
+	                   const Atom&       value) override {}
+
+	void add_port(RunContext& ctx, EnginePort* port) override;
+	void remove_port(RunContext& ctx, EnginePort* port) override;
+	void register_port(EnginePort& port) override {}
+	void unregister_port(EnginePort& port) override {}
+
+	void append_time_events(RunContext& ctx, Buffer& buffer) override;
+
+	SampleCount frame_time() const override;
+
+	int real_time_priority() override { return -1; }
+
+	SampleCount block_length() const override { return _block_length; }
+	size_t      seq_size()     const override { return _seq_size; }
+	SampleRate  sample_rate()  const override { return _sample_rate; }
+
+private:
+	using Ports = boost::intrusive::slist<EnginePort,
+	                                      boost::intrusive::cache_last<true>>;
+
+	bool open_files();
+	bool close_files();
+	void run();
+
+	Engine&                                _engine;
+	Ports                                  _ports;
+	std::vector<std::unique_ptr<PortFile>> _files;
+	std::unique_ptr<std::thread>           _thread;
+	LV2_Atom_Forge                         _forge;
+	const FilePath                         _input_dir;
+	const FilePath                         _output_dir;
+	SampleRate                             _sample_rate;
+	SampleCount                            _length;
+	uint32_t                               _block_length;
+	size_t                                 _seq_size;
+	std::atomic<bool>                      _exit_flag;
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_OFFLINEDRIVER_HPP
@@ -0,0 +1,162 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PluginCache.hpp"
+
+#include "ingen/filesystem.hpp"
+#include "ingen_config.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+namespace ingen {
+namespace server {
+
+/** First line of the cache file, changed whenever the format changes.
+ *
+ * This includes the Ingen version, since which plugins are supported depends
+ * on the features and port types that this version supports.
+ */
+static const char* const cache_header = "ingen-plugin-cache 2 " INGEN_VERSION;
+
+PluginCache::PluginCache(FilePath path)
+	: _path(std::move(path))
+	, _dirty(false)
+{}
+
+void
+PluginCache::load()
+{
+	std::ifstream file(_path.string());
+	std::string   line;
+	if (!file || !std::getline(file, line) || line != cache_header) {
+		return;  // Missing or incompatible, start from scratch
+	}
+
+	while (std::getline(file, line)) {
+		std::istringstream ss(line);
+		Entry              entry;
+		int                supported = 0;
+		std::string        uri;
+		if (ss >> entry.stamp >> supported >> entry.minor_version >>
+		    entry.micro_version >> uri) {
+			entry.supported = supported;
+			_entries[uri]   = entry;
+		}
+	}
+}
+
+bool
+PluginCache::save()
+{
+	const bool stale = std::any_of(_entries.begin(),
+	                               _entries.end(),
+	                               [](const Entries::value_type& e) {
+		                               return !e.second.used;
+	                               });
+
+	if (!_dirty && !stale) {
+		return true;
+	}
+
+	if (!filesystem::create_directories(_path.parent_path())) {
+		return false;
+	}
+
+	// Write to a temporary file and rename so a crash never leaves it partial
+	const FilePath tmp_path = FilePath(_path.string() + ".tmp");
+	{
+		std::ofstream file(tmp_path.string());
+		file << cache_header << '\n';
+		for (const auto& e : _entries) {
+			if (e.second.used) {
+				file << e.second.stamp << ' ' << e.second.supported << ' '
+				     << e.second.minor_version << ' '
+				     << e.second.micro_version << ' ' << e.first << '\n';
+			}
+		}
+
+		if (!file.flush()) {
+			return false;
+		}
+	}
+
+	if (rename(tmp_path.c_str(), _path.c_str())) {
+		return false;
+	}
+
+	_dirty = false;
+	return true;
+}
+
+const PluginCache::Entry*
+PluginCache::find(const URI& uri, int64_t stamp)
+{
+	auto i = _entries.find(uri.string());
+	if (i == _entries.end() || !stamp || i->second.stamp != stamp) {
+		return nullptr;
+	}
+
+	i->second.used = true;
+	return &i->second;
+}
+
+void
+PluginCache::insert(const URI& uri, const Entry& entry)
+{
+	Entry& e = _entries[uri.string()];
+	e      = entry;
+	e.used = true;
+	_dirty = true;
+}
+
+static int64_t
+file_stamp(const LilvNode* node)
+{
+	char* const path = lilv_file_uri_parse(lilv_node_as_uri(node), nullptr);
+
+	const int64_t stamp =
+	    path ? int64_t(filesystem::last_write_time(FilePath(path))) : 0;
+
+	lilv_free(path);
+	return stamp;
+}
+
+int64_t
+PluginCache::stamp(const LilvPlugin* plugin)
+{
+	int64_t stamp = file_stamp(lilv_plugin_get_bundle_uri(plugin));
+	if (!stamp) {
+		return 0;
+	}
+
+	const LilvNodes* data_uris = lilv_plugin_get_data_uris(plugin);
+	LILV_FOREACH(nodes, i, data_uris) {
+		const int64_t s = file_stamp(lilv_nodes_get(data_uris, i));
+		if (!s) {
+			return 0;
+		}
+		stamp = std::max(stamp, s);
+	}
+
+	return stamp;
+}
+
+} // namespace server
+} // namespace ingen
@@ -0,0 +1,89 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_PLUGINCACHE_HPP
+#define INGEN_ENGINE_PLUGINCACHE_HPP
+
+#include "ingen/FilePath.hpp"
+#include "ingen/URI.hpp"
+#include "lilv/lilv.h"
+#include "raul/Noncopyable.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace ingen {
+namespace server {
+
+/** Persistent record of which LV2 plugins are supported.
+ *
+ * Checking whether a plugin is supported requires loading all of its data,
+ * which is slow when many plugins are installed.  This records the result for
+ * each plugin along with a stamp of the modification times of its files, so
+ * that only plugins which have changed since the last run are checked again.
+ *
+ * \ingroup engine
+ */
+class PluginCache : public raul::Noncopyable
+{
+public:
+	struct Entry
+	{
+		int64_t stamp         = 0;      ///< Latest modification time of files
+		bool    supported     = false;  ///< True iff plugin can be loaded
+		int32_t minor_version = -1;     ///< lv2:minorVersion, or -1
+		int32_t micro_version = -1;     ///< lv2:microVersion, or -1
+		bool    used          = false;  ///< True iff seen since loading
+	};
+
+	explicit PluginCache(FilePath path);
+
+	/** Read entries from the cache file, if it exists. */
+	void load();
+
+	/** Write all used entries to the cache file if anything has changed.
+	 *
+	 * @return false if the file could not be written.
+	 */
+	bool save();
+
+	/** Return the entry for a plugin if it is up to date, or null. */
+	const Entry* find(const URI& uri, int64_t stamp);
+
+	/** Add or replace the entry for a plugin. */
+	void insert(const URI& uri, const Entry& entry);
+
+	/** Return a stamp of the modification times of a plugin's files.
+	 *
+	 * This does not load the plugin data, only the bundle directory and data
+	 * files listed in the manifest are checked.  Zero is returned if any of
+	 * these do not exist, which never matches a cached entry.
+	 */
+	static int64_t stamp(const LilvPlugin* plugin);
+
+private:
+	using Entries = std::unordered_map<std::string, Entry>;
+
+	FilePath _path;
+	Entries  _entries;
+	bool     _dirty;
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_PLUGINCACHE_HPP
@@ -42,14 +42,18 @@
 namespace ingen {
 namespace server {
 
-static const uint32_t monitor_rate = 25.0;  // Hz
+static const uint32_t monitor_rate          = 25.0;  // Hz
+static const uint32_t degraded_monitor_rate = 5.0;   // Hz when overloaded
 
 /** The length of time between monitor updates in frames */
 static inline uint32_t
 monitor_period(const Engine& engine)
 {
-	return std::max(engine.block_length(),
-	                engine.sample_rate() / monitor_rate);
+	const uint32_t rate = engine.degraded(Engine::Degradation::MONITOR)
+		? degraded_monitor_rate
+		: monitor_rate;
+
+	return std::max(engine.block_length(), engine.sample_rate() / rate);
 }
 
 PortImpl::PortImpl(BufferFactory&      bufs,
@@ -66,6 +70,7 @@ PortImpl::PortImpl(BufferFactory&      bufs,
 	, _bufs(bufs)
 	, _index(index)
 	, _poly(poly)
+	, _allocated_poly(poly)
 	, _buffer_size(buffer_size)
 	, _frames_since_monitor(0)
 	, _monitor_value(0.0f)
@@ -77,6 +82,7 @@ PortImpl::PortImpl(BufferFactory&      bufs,
 	, _max(bufs.forge().make(1.0f))
 	, _voices(bufs.maid().make_managed<Voices>(poly))
 	, _connected_flag(false)
+	, _n_dependants(0)
 	, _monitored(false)
 	, _force_monitor_update(false)
 	, _is_morph(false)
@@ -342,20 +348,24 @@ PortImpl::prepare_poly(BufferFactory& bufs, uint32_t poly)
 	if (_is_driver_port || _parent->is_main() ||
 	    (_type == PortType::ATOM && !_value.is_valid())) {
 		return false;
-	} else if (_poly == poly) {
-		return true;
-	} else if (_prepared_voices && _prepared_voices->size() != poly) {
+	} else if (_poly == poly || poly <= _allocated_poly) {
+		return true;  // Enough voices already, apply only changes the count
+	}
+
+	const uint32_t capacity = bufs.engine().voice_capacity(poly);
+	if (_prepared_voices && _prepared_voices->size() != capacity) {
 		_prepared_voices.reset();
 	}
 
 	if (!_prepared_voices) {
 		_prepared_voices = bufs.maid().make_managed<Voices>(
-			poly, *_voices, Voice());
+			capacity, *_voices, Voice());
 	}
 
 	get_buffers(bufs, &BufferFactory::get_buffer,
 	            _prepared_voices, _prepared_voices->size(), num_arcs());
 
+	_allocated_poly = capacity;
 	return true;
 }
 
@@ -365,17 +375,27 @@ PortImpl::apply_poly(RunContext& ctx, uint32_t poly)
 	if (_parent->is_main() ||
 	    (_type == PortType::ATOM && !_value.is_valid())) {
 		return false;
-	} else if (!_prepared_voices) {
+	}
+
+	if (_prepared_voices) {
+		// Apply a new set of voices from a preceding call to prepare_poly
+		assert(poly <= _prepared_voices->size());
+		_voices = std::move(_prepared_voices);
+	} else if (poly == _poly || poly > _voices->size()) {
 		return true;
 	}
 
-	assert(poly == _prepared_voices->size());
+	// Clear outputs of voices which were allocated but not running
+	if (is_output() && !_is_driver_port) {
+		for (uint32_t v = _poly; v < poly; ++v) {
+			if (_voices->at(v).buffer) {
+				_voices->at(v).buffer->clear();
+			}
+		}
+	}
 
 	_poly = poly;
 
-	// Apply a new set of voices from a preceding call to prepare_poly
-	_voices = std::move(_prepared_voices);
-
 	if (is_a(PortType::CONTROL) || is_a(PortType::CV)) {
 		set_control_value(ctx, ctx.start(), _value.get<float>());
 	}
@@ -394,8 +414,11 @@ PortImpl::set_buffer_size(RunContext&, BufferFactory&, size_t size)
 {
 	_buffer_size = size;
 
-	for (uint32_t v = 0; v < _poly; ++v) {
-		_voices->at(v).buffer->resize(size);
+	// Resize all allocated voices, since inactive ones may be used again
+	for (uint32_t v = 0; v < _voices->size(); ++v) {
+		if (_voices->at(v).buffer) {
+			_voices->at(v).buffer->resize(size);
+		}
 	}
 
 	connect_buffers();
@@ -120,7 +120,9 @@ public:
 
 	/** Prepare for a new (external) polyphony value.
 	 *
-	 * Preprocessor thread, poly is actually applied by apply_poly.
+	 * Preprocessor thread, poly is actually applied by apply_poly.  Voices are
+	 * only allocated if there are fewer than `poly`, in which case enough for
+	 * Engine::voice_capacity() are allocated so that later increases are free.
 	 */
 	bool prepare_poly(BufferFactory& bufs, uint32_t poly) override;
 
@@ -151,7 +153,9 @@ public:
 		return _voices->at((_poly == 1) ? 0 : voice).buffer;
 	}
 	inline BufferRef prepared_buffer(uint32_t voice) const {
-		return _prepared_voices->at(voice).buffer;
+		return (_prepared_voices && voice < _prepared_voices->size())
+			? _prepared_voices->at(voice).buffer
+			: BufferRef();
 	}
 
 	void update_set_state(const RunContext& ctx, uint32_t v);
@@ -177,6 +181,12 @@ public:
 
 	bool is_driver_port() const { return _is_driver_port; }
 
+	/** Return true iff an arc reads from this port (audio thread only). */
+	bool has_dependants() const { return _n_dependants > 0; }
+
+	void add_dependant()    { ++_n_dependants; }
+	void remove_dependant() { --_n_dependants; }
+
 	/** Called once per process cycle */
 	virtual void pre_process(RunContext& ctx);
 	virtual void pre_run(RunContext& ctx);
@@ -226,6 +236,13 @@ public:
 		return (_prepared_voices) ? _prepared_voices->size() : 1;
 	}
 
+	/** Return the number of allocated voices (pre-process thread).
+	 *
+	 * This may be greater than poly() if polyphony has been decreased, or
+	 * increased with a larger voice capacity.
+	 */
+	uint32_t allocated_poly() const { return _allocated_poly; }
+
 	void set_buffer_size(RunContext& ctx, BufferFactory& bufs, size_t size);
 
 	/** Return true iff this port is explicitly monitored.
@@ -298,6 +315,7 @@ protected:
 	BufferFactory&            _bufs;
 	uint32_t                  _index;
 	uint32_t                  _poly;
+	uint32_t                  _allocated_poly;  ///< Pre-process thread only
 	uint32_t                  _buffer_size;
 	uint32_t                  _frames_since_monitor;
 	float                     _monitor_value;
@@ -311,6 +329,7 @@ protected:
 	raul::managed_ptr<Voices> _prepared_voices;
 	BufferRef                 _user_buffer;
 	std::atomic_flag          _connected_flag;
+	uint32_t                  _n_dependants;  ///< Audio thread only
 	bool                      _monitored;
 	bool                      _force_monitor_update;
 	bool                      _is_morph;
@@ -16,10 +16,12 @@
 
 #include "PreProcessor.hpp"
 
+#include "BlockPool.hpp"
 #include "Engine.hpp"
 #include "Event.hpp"
 #include "PostProcessor.hpp"
 #include "PreProcessContext.hpp"
+#include "Profiler.hpp"
 #include "RunContext.hpp"
 #include "ThreadManager.hpp"
 #include "UndoStack.hpp"
@@ -82,10 +84,14 @@ PreProcessor::event(Event* const ev, Event::Mode mode)
 }
 
 unsigned
-PreProcessor::process(RunContext& ctx, PostProcessor& dest, size_t limit)
+PreProcessor::process(RunContext&    ctx,
+                      PostProcessor& dest,
+                      size_t         limit,
+                      bool           limit_urgent)
 {
 	Event* const head        = _head.load();
 	size_t       n_processed = 0;
+	size_t       n_limited   = 0;
 	Event*       ev          = head;
 	Event*       last        = ev;
 	while (ev && ev->is_prepared()) {
@@ -123,8 +129,15 @@ PreProcessor::process(RunContext& ctx, PostProcessor& dest, size_t limit)
 		}
 
 		// Execute event
-		ev->execute(ctx);
+		{
+			const ProfileScope profile(
+				ctx.profiler(), ctx.id(), ProfileSpan::Kind::EVENT, ev);
+			ev->execute(ctx);
+		}
 		++n_processed;
+		if (limit_urgent || !ev->is_urgent()) {
+			++n_limited;
+		}
 
 		// Unblock pre-processing if this is a non-bundled atomic event
 		if (ev->get_execution() == Event::Execution::ATOMIC) {
@@ -137,7 +150,7 @@ PreProcessor::process(RunContext& ctx, PostProcessor& dest, size_t limit)
 		ev   = ev->next();
 
 		if (_block_state != BlockState::PROCESSING &&
-		    limit && n_processed >= limit) {
+		    limit && n_limited >= limit) {
 			break;
 		}
 	}
@@ -182,12 +195,20 @@ PreProcessor::run()
 
 	ThreadManager::set_flag(THREAD_PRE_PROCESS);
 
-	Event* back = nullptr;
+	Event* back      = nullptr;
+	bool   refilling = false;
 	while (!_exit_flag) {
-		if (!_sem.timed_wait(std::chrono::seconds(1))) {
+		// Poll quickly while there are spare blocks to instantiate
+		const auto timeout = refilling ? std::chrono::milliseconds(10)
+		                               : std::chrono::milliseconds(1000);
+		if (!_sem.timed_wait(timeout)) {
+			// Idle, so instantiate a spare block if necessary
+			refilling = _engine.block_pool()->refill();
 			continue;
 		}
 
+		refilling = true;
+
 		if (!back) {
 			// Ran off end, find new unprepared back
 			back = _head;
@@ -50,11 +50,15 @@ public:
 	void event(Event* ev, Event::Mode mode);
 
 	/** Process events for a cycle.
+	 *
+	 * @param limit Maximum number of events to process, or zero for no limit.
+	 * @param limit_urgent If false, urgent events do not count towards limit.
 	 * @return The number of events processed.
 	 */
 	unsigned process(RunContext&    ctx,
 	                 PostProcessor& dest,
-	                 size_t         limit = 0);
+	                 size_t         limit        = 0,
+	                 bool           limit_urgent = true);
 
 protected:
 	void run();
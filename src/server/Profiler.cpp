@@ -0,0 +1,289 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Profiler.hpp"
+
+#include "NodeImpl.hpp"
+
+#include "ingen/Atom.hpp"
+#include "ingen/Forge.hpp"
+#include "ingen/URIs.hpp"
+#include "lv2/atom/atom.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace ingen {
+namespace server {
+
+constexpr unsigned ProfileHistogram::n_buckets;
+
+void
+ProfileHistogram::add(uint64_t nanoseconds)
+{
+	unsigned bucket = 0;
+	for (uint64_t us = nanoseconds / 1000; us && bucket < n_buckets - 1;
+	     us >>= 1U) {
+		++bucket;
+	}
+
+	++count;
+	++buckets[bucket];
+	total += nanoseconds;
+	if (nanoseconds > max) {
+		max = nanoseconds;
+	}
+}
+
+Profiler::Profiler(size_t   n_threads,
+                   uint32_t ring_size,
+                   size_t   trace_size,
+                   bool     profile,
+                   bool     trace)
+	: _trace_size(trace_size)
+	, _n_dropped(0)
+	, _enabled(profile || trace)
+	, _profiling(profile)
+	, _tracing(trace)
+	, _reset_profile(false)
+	, _reset_trace(false)
+{
+	for (size_t i = 0; i < n_threads + 1; ++i) {
+		_rings.emplace_back(std::make_unique<raul::RingBuffer>(
+			uint32_t(ring_size * sizeof(ProfileSpan))));
+	}
+}
+
+void
+Profiler::update_enabled()
+{
+	_enabled = _profiling || _tracing;
+}
+
+void
+Profiler::set_enabled(bool enabled)
+{
+	if (enabled && !_profiling) {
+		_reset_profile = true;
+	}
+	_profiling = enabled;
+	update_enabled();
+}
+
+void
+Profiler::set_tracing(bool tracing)
+{
+	if (tracing && !_tracing) {
+		_reset_trace = true;
+	}
+	_tracing = tracing;
+	update_enabled();
+}
+
+void
+Profiler::record(unsigned          thread,
+                 ProfileSpan::Kind kind,
+                 const void*       object,
+                 uint64_t          start,
+                 uint64_t          end)
+{
+	raul::RingBuffer& ring = *_rings[thread];
+	if (ring.write_space() >= sizeof(ProfileSpan)) {
+		const ProfileSpan span{kind, object, start, end};
+		ring.write(sizeof(span), &span);
+	} else {
+		++_n_dropped;
+	}
+}
+
+void
+Profiler::process()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (_reset_profile.exchange(false)) {
+		_histograms.clear();
+		_events = ProfileHistogram();
+	}
+
+	if (_reset_trace.exchange(false)) {
+		_trace.clear();
+		_names.clear();
+		_n_dropped = 0;
+	}
+
+	const bool profiling = _profiling;
+	const bool tracing   = _tracing;
+
+	ProfileSpan span{};
+	for (unsigned t = 0; t < _rings.size(); ++t) {
+		raul::RingBuffer& ring = *_rings[t];
+		while (ring.read(sizeof(span), &span) == sizeof(span)) {
+			if (tracing) {
+				if ((span.kind == ProfileSpan::Kind::BLOCK ||
+				     span.kind == ProfileSpan::Kind::MIX) &&
+				    !_names.count(span.object)) {
+					// Objects are deleted only after this, so this is safe
+					const auto* node = static_cast<const NodeImpl*>(span.object);
+					_names.emplace(span.object, node->path());
+				}
+
+				_trace.push_back({span, t});
+				if (_trace.size() > _trace_size) {
+					_trace.pop_front();
+				}
+			}
+
+			if (profiling) {
+				const uint64_t duration = span.end - span.start;
+				switch (span.kind) {
+				case ProfileSpan::Kind::BLOCK:
+				case ProfileSpan::Kind::MIX:
+					_histograms[span.object].add(duration);
+					break;
+				case ProfileSpan::Kind::EVENT:
+					_events.add(duration);
+					break;
+				default:
+					break;  // Only meaningful in traces
+				}
+			}
+		}
+	}
+}
+
+void
+Profiler::forget(const void* object)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_histograms.erase(object);
+	_names.erase(object);
+}
+
+Properties
+Profiler::properties(const URIs& uris, const void* object) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const ProfileHistogram* histogram = &_events;
+	if (object) {
+		const auto i = _histograms.find(object);
+		if (i == _histograms.end()) {
+			return Properties();
+		}
+		histogram = &i->second;
+	} else if (!_events.count) {
+		return Properties();
+	}
+
+	// Build an atom:Vector of bucket counts
+	const LV2_Atom_Vector_Body head{sizeof(int32_t), uris.forge.Int};
+	uint8_t body[sizeof(head) + sizeof(histogram->buckets)];
+	memcpy(body, &head, sizeof(head));
+	memcpy(body + sizeof(head), histogram->buckets, sizeof(histogram->buckets));
+
+	const int64_t count = static_cast<int64_t>(histogram->count);
+	const float   mean  = histogram->total / 1000.0f / histogram->count;
+	const float   max   = histogram->max / 1000.0f;
+
+	return { { uris.ingen_runCount,
+	           Forge::alloc(sizeof(count), uris.forge.Long, &count) },
+	         { uris.ingen_meanRunTime, uris.forge.make(mean) },
+	         { uris.ingen_maxRunTime, uris.forge.make(max) },
+	         { uris.ingen_runHistogram,
+	           Forge::alloc(sizeof(body), uris.forge.Vector, body) } };
+}
+
+static const char*
+kind_name(ProfileSpan::Kind kind)
+{
+	switch (kind) {
+	case ProfileSpan::Kind::BLOCK:
+		return "block";
+	case ProfileSpan::Kind::MIX:
+		return "mix";
+	case ProfileSpan::Kind::TASK:
+		return "task";
+	case ProfileSpan::Kind::EVENT:
+		return "event";
+	case ProfileSpan::Kind::CLAIM:
+		return "claim";
+	case ProfileSpan::Kind::STEAL:
+		return "steal";
+	case ProfileSpan::Kind::SPIN:
+		return "spin";
+	case ProfileSpan::Kind::NOTIFY:
+		break;
+	}
+	return "notify";
+}
+
+bool
+Profiler::write_trace(const std::string& path)
+{
+	std::unique_ptr<FILE, decltype(&fclose)> file{fopen(path.c_str(), "w"),
+	                                              &fclose};
+	if (!file) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	fprintf(file.get(), "{\"traceEvents\":[\n");
+
+	// Name threads so the timeline is readable
+	for (unsigned t = 0; t < _rings.size(); ++t) {
+		fprintf(file.get(),
+		        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+		        "\"tid\":%u,\"args\":{\"name\":\"%s %u\"}},\n",
+		        t,
+		        t == main_thread() ? "main" : "run",
+		        t);
+	}
+
+	const uint64_t origin = _trace.empty() ? 0 : _trace.front().span.start;
+	for (const auto& s : _trace) {
+		const char* const cat  = kind_name(s.span.kind);
+		const auto        n    = _names.find(s.span.object);
+		const char* const name = (n != _names.end()) ? n->second.c_str() : cat;
+		const double      ts   = (s.span.start - origin) / 1000.0;
+
+		if (s.span.kind == ProfileSpan::Kind::CLAIM ||
+		    s.span.kind == ProfileSpan::Kind::STEAL) {
+			fprintf(file.get(),
+			        "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+			        "\"ts\":%.3f,\"pid\":1,\"tid\":%u},\n",
+			        name, cat, ts, s.thread);
+		} else {
+			fprintf(file.get(),
+			        "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+			        "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u},\n",
+			        name, cat, ts, (s.span.end - s.span.start) / 1000.0,
+			        s.thread);
+		}
+	}
+
+	// Final event without a trailing comma, recording any dropped spans
+	fprintf(file.get(),
+	        "{\"name\":\"dropped\",\"ph\":\"C\",\"ts\":0,\"pid\":1,"
+	        "\"args\":{\"spans\":%u}}\n]}\n",
+	        _n_dropped.load());
+
+	return !ferror(file.get());
+}
+
+} // namespace server
+} // namespace ingen
@@ -0,0 +1,229 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_PROFILER_HPP
+#define INGEN_ENGINE_PROFILER_HPP
+
+#include "ingen/Clock.hpp"
+#include "ingen/Properties.hpp"
+#include "raul/Noncopyable.hpp"
+#include "raul/RingBuffer.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ingen {
+
+class URIs;
+
+namespace server {
+
+/** A span of time spent on some piece of work in a run context.
+ * \ingroup engine
+ */
+struct ProfileSpan
+{
+	enum class Kind : uint32_t {
+		BLOCK,   ///< BlockImpl::process(), object is the block
+		MIX,     ///< Input port mixdown, object is the port
+		TASK,    ///< Sequential or parallel task, object is the Task
+		EVENT,   ///< Event execution, object is the Event
+		CLAIM,   ///< Parallel task claimed (instant), object is the Task
+		STEAL,   ///< Task stolen from another thread (instant)
+		SPIN,    ///< Spinning while waiting for other threads to finish
+		NOTIFY   ///< Emitting notifications to clients
+	};
+
+	Kind        kind;
+	const void* object;
+	uint64_t    start;  ///< Start time in nanoseconds
+	uint64_t    end;    ///< End time in nanoseconds
+};
+
+/** Statistics about the run time of some object.
+ *
+ * Bucket 0 counts runs shorter than 1 microsecond, and bucket i counts runs
+ * from 2^(i-1) up to 2^i microseconds.  The last bucket counts everything
+ * longer than that.
+ *
+ * \ingroup engine
+ */
+struct ProfileHistogram
+{
+	static constexpr unsigned n_buckets = 16;
+
+	void add(uint64_t nanoseconds);
+
+	uint64_t count   = 0;
+	uint64_t total   = 0;  ///< Total run time in nanoseconds
+	uint64_t max     = 0;  ///< Maximum run time in nanoseconds
+	int32_t  buckets[n_buckets]{};
+};
+
+/** Realtime profiler and tracer for blocks, port mixdown, tasks, and events.
+ *
+ * Each run context writes spans into its own ring, which is drained in the
+ * post-processor.  When profiling, spans are aggregated into histograms.  When
+ * tracing, the most recent spans are kept so they can be written as a Chrome
+ * trace.  When neither is enabled, the only cost in the audio thread is
+ * checking a flag.
+ *
+ * There is one ring for each run context, and one more for the main thread,
+ * which is used for spans recorded while post-processing.
+ *
+ * \ingroup engine
+ */
+class Profiler : public raul::Noncopyable
+{
+public:
+	Profiler(size_t   n_threads,
+	         uint32_t ring_size,
+	         size_t   trace_size,
+	         bool     profile,
+	         bool     trace);
+
+	/** Return true iff spans should be recorded (realtime safe). */
+	inline bool enabled() const {
+		return _enabled.load(std::memory_order_relaxed);
+	}
+
+	/** Return the index of the ring for the main thread. */
+	inline unsigned main_thread() const { return _rings.size() - 1; }
+
+	/** Enable or disable profiling, resetting statistics if enabling. */
+	void set_enabled(bool enabled);
+
+	/** Enable or disable tracing, clearing the trace if enabling. */
+	void set_tracing(bool tracing);
+
+	/** Return true iff profiling is enabled. */
+	bool profiling() const { return _profiling; }
+
+	/** Return true iff tracing is enabled. */
+	bool tracing() const { return _tracing; }
+
+	/** Return the current time in nanoseconds (realtime safe). */
+	inline uint64_t now() const { return _clock.now_nanoseconds(); }
+
+	/** Record a span in the ring for a thread (realtime safe). */
+	void record(unsigned          thread,
+	            ProfileSpan::Kind kind,
+	            const void*       object,
+	            uint64_t          start,
+	            uint64_t          end);
+
+	/** Record an instant event in the ring for a thread (realtime safe). */
+	inline void mark(unsigned thread, ProfileSpan::Kind kind, const void* object) {
+		if (enabled()) {
+			const uint64_t t = now();
+			record(thread, kind, object, t, t);
+		}
+	}
+
+	/** Aggregate all recorded spans (post-processor thread only). */
+	void process();
+
+	/** Write the recorded trace in Chrome trace event JSON format.
+	 *
+	 * This can be loaded into chrome://tracing or the Perfetto UI.
+	 *
+	 * @return false if the file could not be written.
+	 */
+	bool write_trace(const std::string& path);
+
+	/** Forget the statistics for an object which is being deleted. */
+	void forget(const void* object);
+
+	/** Return the statistics for an object as properties.
+	 *
+	 * This is empty if the object has never been profiled.  Statistics for
+	 * event execution are returned for a null object.
+	 */
+	Properties properties(const URIs& uris, const void* object) const;
+
+private:
+	/** A span recorded by some thread, kept for tracing. */
+	struct TracedSpan
+	{
+		ProfileSpan span;
+		unsigned    thread;
+	};
+
+	using Histograms = std::unordered_map<const void*, ProfileHistogram>;
+	using Names      = std::unordered_map<const void*, std::string>;
+
+	void update_enabled();
+
+	Clock                                          _clock;
+	std::vector<std::unique_ptr<raul::RingBuffer>> _rings;
+	mutable std::mutex                             _mutex;
+	Histograms                                     _histograms;
+	ProfileHistogram                               _events;
+	std::deque<TracedSpan>                         _trace;
+	Names                                          _names;
+	const size_t                                   _trace_size;
+	std::atomic<uint32_t>                          _n_dropped;
+	std::atomic<bool>                              _enabled;
+	std::atomic<bool>                              _profiling;
+	std::atomic<bool>                              _tracing;
+	std::atomic<bool>                              _reset_profile;
+	std::atomic<bool>                              _reset_trace;
+};
+
+/** Scope guard which records a span from construction to destruction.
+ * \ingroup engine
+ */
+class ProfileScope
+{
+public:
+	inline ProfileScope(Profiler&         profiler,
+	                    unsigned          thread,
+	                    ProfileSpan::Kind kind,
+	                    const void*       object)
+		: _profiler(profiler.enabled() ? &profiler : nullptr)
+		, _object(object)
+		, _start(_profiler ? profiler.now() : 0)
+		, _thread(thread)
+		, _kind(kind)
+	{}
+
+	inline ~ProfileScope() {
+		if (_profiler) {
+			_profiler->record(_thread, _kind, _object, _start, _profiler->now());
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	Profiler* const         _profiler;
+	const void* const       _object;
+	const uint64_t          _start;
+	const unsigned          _thread;
+	const ProfileSpan::Kind _kind;
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_PROFILER_HPP
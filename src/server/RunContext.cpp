@@ -19,12 +19,15 @@
 #include "Broadcaster.hpp"
 #include "BufferFactory.hpp"
 #include "Engine.hpp"
+#include "NodeImpl.hpp"
 #include "PortImpl.hpp"
+#include "Profiler.hpp"
 #include "Task.hpp"
 
 #include "ingen/Atom.hpp"
 #include "ingen/Forge.hpp"
 #include "ingen/Log.hpp"
+#include "ingen/Node.hpp"
 #include "ingen/URI.hpp"
 #include "ingen/URIMap.hpp"
 #include "ingen/URIs.hpp"
@@ -42,15 +45,15 @@ namespace server {
 
 struct Notification
 {
-	explicit inline Notification(PortImpl* p = nullptr,
+	explicit inline Notification(NodeImpl* n = nullptr,
 	                             FrameTime f = 0,
 	                             LV2_URID  k = 0,
 	                             uint32_t  s = 0,
 	                             LV2_URID  t = 0)
-		: port(p), time(f), key(k), size(s), type(t)
+		: node(n), time(f), key(k), size(s), type(t)
 	{}
 
-	PortImpl* port;
+	NodeImpl* node;
 	FrameTime time;
 	LV2_URID  key;
 	uint32_t  size;
@@ -63,6 +66,7 @@ RunContext::RunContext(Engine&           engine,
                        bool              threaded)
 	: _engine(engine)
 	, _event_sink(event_sink)
+	, _profiler(*engine.profiler())
 	, _task(nullptr)
 	, _thread(threaded ? new std::thread(&RunContext::run, this) : nullptr)
 	, _id(id)
@@ -77,6 +81,7 @@ RunContext::RunContext(Engine&           engine,
 RunContext::RunContext(const RunContext& copy)
 	: _engine(copy._engine)
 	, _event_sink(copy._event_sink)
+	, _profiler(copy._profiler)
 	, _task(nullptr)
 	, _thread(nullptr)
 	, _id(copy._id)
@@ -97,12 +102,12 @@ RunContext::must_notify(const PortImpl* port) const
 bool
 RunContext::notify(LV2_URID    key,
                    FrameTime   time,
-                   PortImpl*   port,
+                   NodeImpl*   node,
                    uint32_t    size,
                    LV2_URID    type,
                    const void* body)
 {
-	const Notification n(port, time, key, size, type);
+	const Notification n(node, time, key, size, type);
 	if (_event_sink->write_space() < sizeof(n) + size) {
 		return false;
 	}
@@ -134,12 +139,17 @@ RunContext::emit_notifications(FrameTime end)
 				const char* key = _engine.world().uri_map().unmap_uri(note.key);
 				if (key) {
 					_engine.broadcaster()->set_property(
-						note.port->uri(), URI(key), value);
-					if (note.port->is_input() &&
+						note.node->uri(), URI(key), value);
+
+					auto* const port =
+						(note.node->graph_type() == Node::GraphType::PORT)
+						? static_cast<PortImpl*>(note.node)
+						: nullptr;
+					if (port && port->is_input() &&
 					    (note.key == uris.ingen_value ||
 					     note.key == uris.midi_binding)) {
 						// FIXME: not thread safe
-						note.port->set_property(URI(key), value);
+						port->set_property(URI(key), value);
 					}
 				} else {
 					_engine.log().rt_error("Error unmapping notification key URI\n");
@@ -157,6 +167,7 @@ void
 RunContext::claim_task(Task* task)
 {
 	if ((_task = task)) {
+		_profiler.mark(_id, ProfileSpan::Kind::CLAIM, task);
 		_engine.signal_tasks_available();
 	}
 }
@@ -199,6 +210,7 @@ RunContext::run()
 {
 	while (_engine.wait_for_tasks()) {
 		for (Task* t = nullptr; (t = _engine.steal_task(0));) {
+			_profiler.mark(_id, ProfileSpan::Kind::STEAL, t);
 			t->run(*this);
 		}
 	}
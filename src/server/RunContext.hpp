@@ -30,7 +30,9 @@ namespace ingen {
 namespace server {
 
 class Engine;
+class NodeImpl;
 class PortImpl;
+class Profiler;
 class Task;
 
 /** Graph execution context.
@@ -79,12 +81,12 @@ public:
 	 */
 	bool must_notify(const PortImpl* port) const;
 
-	/** Send a notification from this run context.
+	/** Send a notification about `node` (usually a port) from this context.
 	 * @return false on failure (ring is full)
 	 */
 	bool notify(LV2_URID    key  = 0,
 	            FrameTime   time = 0,
-	            PortImpl*   port = nullptr,
+	            NodeImpl*   node = nullptr,
 	            uint32_t    size = 0,
 	            LV2_URID    type = 0,
 	            const void* body = nullptr);
@@ -130,6 +132,7 @@ public:
     void join();
 
 	inline Engine&     engine()   const { return _engine; }
+	inline Profiler&   profiler() const { return _profiler; }
 	inline Task*       task()     const { return _task; }
 	inline unsigned    id()       const { return _id; }
 	inline FrameTime   start()    const { return _start; }
@@ -145,6 +148,7 @@ protected:
 
 	Engine&                      _engine;     ///< Engine we're running in
 	raul::RingBuffer*            _event_sink; ///< Updates from process context
+	Profiler&                    _profiler;   ///< Profiler for run times
 	Task*                        _task;       ///< Currently executing task
 	std::unique_ptr<std::thread> _thread;     ///< Thread (or null for main)
 	unsigned                     _id;         ///< Context ID
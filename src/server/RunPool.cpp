@@ -0,0 +1,178 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RunPool.hpp"
+
+#include "Engine.hpp"
+#include "Profiler.hpp"
+#include "RunContext.hpp"
+#include "Task.hpp"
+
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+
+namespace ingen {
+namespace server {
+
+static bool
+set_thread_priority(std::thread& thread, int priority)
+{
+	const int   policy = (priority > 0) ? SCHED_FIFO : SCHED_OTHER;
+	sched_param sp{};
+	sp.sched_priority = (priority > 0) ? priority : 0;
+	return !pthread_setschedparam(thread.native_handle(), policy, &sp);
+}
+
+RunPool::~RunPool()
+{
+	_quit_flag = true;
+	_tasks_available.notify_all();
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+}
+
+std::shared_ptr<RunPool>
+RunPool::instance(unsigned n_threads)
+{
+	static std::mutex             mutex;
+	static std::weak_ptr<RunPool> pool;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::shared_ptr<RunPool> ret = pool.lock();
+	if (!ret) {
+		ret  = std::shared_ptr<RunPool>(new RunPool());
+		pool = ret;
+	}
+
+	ret->grow(n_threads);
+	return ret;
+}
+
+bool
+RunPool::grow(unsigned n_threads)
+{
+	std::unique_lock<Mutex> lock(_engines_mutex);
+
+	bool success = true;
+	_orders.resize(std::max(size_t(n_threads), _orders.size()));
+	for (auto& order : _orders) {
+		order.reserve(_engines.size());
+	}
+
+	while (_threads.size() < n_threads) {
+		_threads.emplace_back(&RunPool::run, this, _threads.size() + 1);
+		success = set_thread_priority(_threads.back(), _priority) && success;
+	}
+
+	return success;
+}
+
+void
+RunPool::add(Engine& engine)
+{
+	std::unique_lock<Mutex> lock(_engines_mutex);
+
+	_engines.push_back(&engine);
+	for (auto& order : _orders) {
+		order.reserve(_engines.size());
+	}
+}
+
+void
+RunPool::remove(Engine& engine)
+{
+	std::unique_lock<Mutex> lock(_engines_mutex);
+
+	_engines.erase(std::remove(_engines.begin(), _engines.end(), &engine),
+	               _engines.end());
+}
+
+void
+RunPool::signal_tasks_available()
+{
+	_tasks_available.notify_all();
+}
+
+bool
+RunPool::set_priority(int priority)
+{
+	std::unique_lock<Mutex> lock(_engines_mutex);
+
+	bool success = true;
+	_priority    = priority;
+	for (auto& thread : _threads) {
+		success = set_thread_priority(thread, priority) && success;
+	}
+
+	return success;
+}
+
+bool
+RunPool::wait_for_tasks()
+{
+	if (!_quit_flag) {
+		std::unique_lock<std::mutex> lock(_tasks_mutex);
+		_tasks_available.wait(lock);
+	}
+	return !_quit_flag;
+}
+
+Task*
+RunPool::steal_task(unsigned id, Engine*& engine)
+{
+	// Try engines which can use this thread, earliest deadline first
+	Order& order = _orders[id - 1];
+	order.clear();
+	for (Engine* e : _engines) {
+		if (id < e->n_threads()) {
+			order.emplace_back(e->deadline(), e);
+		}
+	}
+
+	std::sort(order.begin(), order.end());
+
+	for (const auto& o : order) {
+		Task* const t = o.second->steal_task(0);
+		if (t) {
+			engine = o.second;
+			return t;
+		}
+	}
+
+	return nullptr;
+}
+
+void
+RunPool::run(unsigned id)
+{
+	while (wait_for_tasks()) {
+		// Engines can not be removed while their tasks are running
+		std::shared_lock<Mutex> lock(_engines_mutex);
+
+		Engine* engine = nullptr;
+		for (Task* t = nullptr; (t = steal_task(id, engine));) {
+			RunContext& ctx = engine->run_context(id);
+			ctx.profiler().mark(id, ProfileSpan::Kind::STEAL, t);
+			t->run(ctx);
+		}
+	}
+}
+
+} // namespace server
+} // namespace ingen
@@ -0,0 +1,107 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_RUNPOOL_HPP
+#define INGEN_ENGINE_RUNPOOL_HPP
+
+#include "raul/Noncopyable.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ingen {
+namespace server {
+
+class Engine;
+class Task;
+
+/** Threads which run parallel tasks for all engines in the process.
+ *
+ * Normally, each engine launches its own threads to help run parallel tasks,
+ * so several engines in one process (for example, several instances of the
+ * Ingen LV2 plugin) oversubscribe the available cores.  Engines may instead
+ * share this pool, which has enough threads for the engine with the most.
+ *
+ * When several engines have tasks available, the one whose cycle has the
+ * earliest deadline is helped first.  Each engine is helped by at most as
+ * many threads as it would have had itself, and its main thread only ever
+ * runs its own tasks.
+ *
+ * \ingroup engine
+ */
+class RunPool : public raul::Noncopyable
+{
+public:
+	~RunPool();
+
+	/** Return the pool for this process, with at least `n_threads` threads.
+	 *
+	 * The pool is created when it is first needed, and destroyed when the
+	 * last reference to it is dropped.
+	 */
+	static std::shared_ptr<RunPool> instance(unsigned n_threads);
+
+	/** Add an engine to be helped by the pool. */
+	void add(Engine& engine);
+
+	/** Remove an engine, after any tasks of it that are running finish. */
+	void remove(Engine& engine);
+
+	/** Wake threads to steal newly available tasks. */
+	void signal_tasks_available();
+
+	/** Set the real-time priority of all threads, or 0 for none.
+	 *
+	 * @return false if the priority of some thread could not be set.
+	 */
+	bool set_priority(int priority);
+
+private:
+	using Mutex = std::shared_timed_mutex;
+
+	/** Engines in the order to try, with their deadlines when sorted. */
+	using Order = std::vector<std::pair<uint64_t, Engine*>>;
+
+	RunPool() = default;
+
+	bool grow(unsigned n_threads);
+	void run(unsigned id);
+	bool wait_for_tasks();
+
+	/** Steal a task for the thread with run context `id`. */
+	Task* steal_task(unsigned id, Engine*& engine);
+
+	Mutex                    _engines_mutex;  ///< Shared while running tasks
+	std::vector<Engine*>     _engines;
+	std::vector<Order>       _orders;  ///< Scratch space for each thread
+	std::vector<std::thread> _threads;
+	std::mutex               _tasks_mutex;
+	std::condition_variable  _tasks_available;
+	int                      _priority{0};
+	std::atomic<bool>        _quit_flag{false};
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_RUNPOOL_HPP
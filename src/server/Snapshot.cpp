@@ -0,0 +1,508 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Snapshot.hpp"
+
+#include "BlockImpl.hpp"
+#include "ClientUpdate.hpp"
+#include "Engine.hpp"
+#include "GraphImpl.hpp"
+
+#include "ingen/AtomReader.hpp"
+#include "ingen/AtomSink.hpp"
+#include "ingen/AtomWriter.hpp"
+#include "ingen/FilePath.hpp"
+#include "ingen/Forge.hpp"
+#include "ingen/Log.hpp"
+#include "ingen/URI.hpp"
+#include "ingen/URIMap.hpp"
+#include "ingen/URIs.hpp"
+#include "ingen/World.hpp"
+#include "ingen_config.h"
+#include "lv2/atom/atom.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+#include "raul/Noncopyable.hpp"
+#include "raul/Path.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef HAVE_MMAP
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace ingen {
+namespace server {
+
+constexpr const char* const Snapshot::extension;
+
+/* A snapshot file is, in native byte order:
+ *
+ *   SnapshotHeader
+ *   n_uris URI table entries, each a SnapshotURI followed by the URI string
+ *   Messages, each an atom
+ *
+ * Everything after the header starts at a multiple of 64 bits, so atoms can be
+ * used directly from a mapped file.
+ */
+
+static const char     snapshot_magic[8] = {'I', 'N', 'G', 'N', 'S', 'N', 'A', 'P'};
+static const uint32_t snapshot_version  = 1U;
+
+struct SnapshotHeader
+{
+	char     magic[8];       ///< snapshot_magic
+	uint32_t version;        ///< snapshot_version
+	uint32_t n_uris;         ///< Number of entries in the URI table
+	uint64_t uris_size;      ///< Size of the URI table in bytes
+	uint64_t messages_size;  ///< Size of all messages in bytes
+};
+
+struct SnapshotURI
+{
+	uint32_t urid;  ///< URID in the engine that wrote the snapshot
+	uint32_t size;  ///< Size of the following string including the null
+};
+
+static inline size_t
+pad_size(size_t size)
+{
+	return (size + 7U) & ~size_t(7U);
+}
+
+/** Call `f` with a reference to every URID in `atom`.
+ *
+ * The type of each atom is visited before its body, so `f` may replace URIDs
+ * and the body will be interpreted according to the replaced type.
+ *
+ * @param space Available space for `atom` in bytes, including its header.
+ * @return false if `atom`, or any atom within it, does not fit in its space.
+ */
+template<typename F>
+static bool
+for_each_urid(const LV2_Atom_Forge& forge, LV2_Atom* atom, size_t space, F& f)
+{
+	if (space < sizeof(LV2_Atom) || space - sizeof(LV2_Atom) < atom->size) {
+		return false;
+	}
+
+	f(atom->type);
+
+	auto* const  body = static_cast<uint8_t*>(LV2_ATOM_BODY(atom));
+	const size_t size = atom->size;
+	if (atom->type == forge.Object) {
+		if (size < sizeof(LV2_Atom_Object_Body)) {
+			return false;
+		}
+
+		auto* obj = reinterpret_cast<LV2_Atom_Object*>(atom);
+		f(obj->body.id);
+		f(obj->body.otype);
+
+		const size_t head = offsetof(LV2_Atom_Property_Body, value);
+		for (size_t o = sizeof(LV2_Atom_Object_Body); o < size;) {
+			auto* p = reinterpret_cast<LV2_Atom_Property_Body*>(body + o);
+			if (size - o < head) {
+				return false;
+			}
+
+			f(p->key);
+			f(p->context);
+			if (!for_each_urid(forge, &p->value, size - o - head, f)) {
+				return false;
+			}
+
+			o += pad_size(head + lv2_atom_total_size(&p->value));
+		}
+	} else if (atom->type == forge.Tuple) {
+		for (size_t o = 0; o < size;) {
+			auto* elem = reinterpret_cast<LV2_Atom*>(body + o);
+			if (!for_each_urid(forge, elem, size - o, f)) {
+				return false;
+			}
+
+			o += pad_size(lv2_atom_total_size(elem));
+		}
+	} else if (atom->type == forge.Vector) {
+		if (size < sizeof(LV2_Atom_Vector_Body)) {
+			return false;
+		}
+
+		auto* vec = reinterpret_cast<LV2_Atom_Vector*>(atom);
+		f(vec->body.child_type);
+		if (vec->body.child_type == forge.URID &&
+		    vec->body.child_size == sizeof(LV2_URID)) {
+			auto* elems = static_cast<LV2_URID*>(
+				LV2_ATOM_CONTENTS(LV2_Atom_Vector, vec));
+			const size_t n = (size - sizeof(vec->body)) / sizeof(LV2_URID);
+			for (size_t i = 0; i < n; ++i) {
+				f(elems[i]);
+			}
+		}
+	} else if (atom->type == forge.Sequence) {
+		if (size < sizeof(LV2_Atom_Sequence_Body)) {
+			return false;
+		}
+
+		auto* seq = reinterpret_cast<LV2_Atom_Sequence*>(atom);
+		f(seq->body.unit);
+
+		const size_t head = offsetof(LV2_Atom_Event, body);
+		for (size_t o = sizeof(LV2_Atom_Sequence_Body); o < size;) {
+			auto* ev = reinterpret_cast<LV2_Atom_Event*>(body + o);
+			if (size - o < head ||
+			    !for_each_urid(forge, &ev->body, size - o - head, f)) {
+				return false;
+			}
+
+			o += pad_size(head + lv2_atom_total_size(&ev->body));
+		}
+	} else if (atom->type == forge.Literal) {
+		if (size < sizeof(LV2_Atom_Literal_Body)) {
+			return false;
+		}
+
+		auto* lit = reinterpret_cast<LV2_Atom_Literal*>(atom);
+		f(lit->body.datatype);
+		f(lit->body.lang);
+	} else if (atom->type == forge.URID) {
+		if (size < sizeof(LV2_URID)) {
+			return false;
+		}
+
+		f(reinterpret_cast<LV2_Atom_URID*>(atom)->body);
+	}
+
+	return true;
+}
+
+/** An AtomSink that appends messages to a buffer. */
+class MessageBuffer : public AtomSink
+{
+public:
+	bool write(const LV2_Atom* msg, int32_t) override {
+		append(msg, lv2_atom_total_size(msg));
+		return true;
+	}
+
+	void append(const void* data, size_t size) {
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		_buf.insert(_buf.end(), bytes, bytes + size);
+		_buf.resize(pad_size(_buf.size()));
+	}
+
+	std::vector<uint8_t>& data() { return _buf; }
+
+private:
+	std::vector<uint8_t> _buf;
+};
+
+/** Save the state of every block in `graph` under `dir`, recursively. */
+static void
+save_states(const GraphImpl&         graph,
+            const FilePath&          dir,
+            std::map<URI, FilePath>& states)
+{
+	for (const auto& b : graph.blocks()) {
+		if (const auto* subgraph = dynamic_cast<const GraphImpl*>(&b)) {
+			save_states(*subgraph, dir, states);
+		} else {
+			const FilePath block_dir = dir / FilePath(b.path().substr(1));
+			if (b.save_state(block_dir)) {
+				states.emplace(b.uri(), block_dir / "state.ttl");
+			}
+		}
+	}
+}
+
+Snapshot::Snapshot(Engine& engine, const GraphImpl& graph, FilePath path)
+	: _path(std::move(path))
+	, _n_uris(0)
+	, _valid(false)
+{
+	World& world = engine.world();
+	URIs&  uris  = world.uris();
+
+	// Describe the graph exactly as a client would see it
+	ClientUpdate update;
+	update.put_graph(&graph);
+
+	// Save plugin state and refer to it from blocks so it is loaded on create
+	std::map<URI, FilePath> states;
+	save_states(graph, FilePath(_path.string() + ".state"), states);
+	for (auto& put : update.puts) {
+		const auto s = states.find(put.uri);
+		if (s != states.end()) {
+			const std::string& state_path = s->second.string();
+			put.properties.erase(uris.state_state);
+			put.properties.emplace(
+				uris.state_state,
+				Forge::alloc(state_path.length() + 1,
+				             uris.forge.Path,
+				             state_path.c_str()));
+		}
+	}
+
+	// Write messages in a bundle so the engine compiles graphs only once
+	MessageBuffer messages;
+	AtomWriter    writer(world.uri_map(), uris, messages);
+	writer.bundle_begin();
+	update.send(writer);
+	writer.bundle_end();
+
+	// Collect every URID used by the messages
+	std::set<LV2_URID> used;
+	auto collect = [&used](LV2_URID& urid) {
+		if (urid) {
+			used.insert(urid);
+		}
+	};
+
+	std::vector<uint8_t>& buf = messages.data();
+	for (size_t offset = 0; offset < buf.size();) {
+		auto* msg = reinterpret_cast<LV2_Atom*>(buf.data() + offset);
+		for_each_urid(uris.forge, msg, buf.size() - offset, collect);
+		offset += pad_size(lv2_atom_total_size(msg));
+	}
+
+	// Build the URI table
+	MessageBuffer table;
+	for (const auto urid : used) {
+		const char* const uri = world.uri_map().unmap_uri(urid);
+		if (!uri) {
+			world.log().error("Snapshot uses unmapped URID %1%\n", urid);
+			return;
+		}
+
+		const SnapshotURI entry{urid, uint32_t(strlen(uri) + 1)};
+		table.append(&entry, sizeof(entry));
+		table.append(uri, entry.size);
+	}
+
+	_table    = std::move(table.data());
+	_messages = std::move(buf);
+	_n_uris   = uint32_t(used.size());
+	_valid    = true;
+}
+
+bool
+Snapshot::write(Log& log) const
+{
+	if (!_valid) {
+		return false;
+	}
+
+	SnapshotHeader head{};
+	memcpy(head.magic, snapshot_magic, sizeof(head.magic));
+	head.version       = snapshot_version;
+	head.n_uris        = _n_uris;
+	head.uris_size     = _table.size();
+	head.messages_size = _messages.size();
+
+	// Write to a temporary file and replace the snapshot only on success
+	const std::string tmp_path = _path.string() + ".tmp";
+	FILE* const       file     = fopen(tmp_path.c_str(), "wb");
+	if (!file) {
+		log.error("Failed to open %1% (%2%)\n", tmp_path, strerror(errno));
+		return false;
+	}
+
+	bool ok = (fwrite(&head, sizeof(head), 1, file) == 1 &&
+	           fwrite(_table.data(), 1, head.uris_size, file) ==
+	           head.uris_size &&
+	           fwrite(_messages.data(), 1, head.messages_size, file) ==
+	           head.messages_size);
+
+	ok = !fclose(file) && ok;
+	if (!ok || rename(tmp_path.c_str(), _path.c_str())) {
+		log.error("Failed to write snapshot %1% (%2%)\n",
+		          _path, strerror(errno));
+		remove(tmp_path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+/** A snapshot file in memory, mapped privately if possible so it can be
+ * patched in place without copying.
+ */
+class SnapshotFile : public raul::Noncopyable
+{
+public:
+	explicit SnapshotFile(const FilePath& path) {
+#ifdef HAVE_MMAP
+		const int   fd = open(path.c_str(), O_RDONLY);
+		struct stat st{};
+		if (fd >= 0 && !fstat(fd, &st) && st.st_size > 0) {
+			void* const map = mmap(nullptr,
+			                       size_t(st.st_size),
+			                       PROT_READ | PROT_WRITE,
+			                       MAP_PRIVATE,
+			                       fd,
+			                       0);
+			if (map != MAP_FAILED) {
+				_data = static_cast<uint8_t*>(map);
+				_size = size_t(st.st_size);
+			}
+		}
+		if (fd >= 0) {
+			close(fd);
+		}
+#else
+		std::unique_ptr<FILE, decltype(&fclose)> file{
+			fopen(path.c_str(), "rb"), &fclose};
+		if (file && !fseek(file.get(), 0, SEEK_END)) {
+			const long size = ftell(file.get());
+			if (size > 0) {
+				// Read into 64-bit words so atoms are aligned
+				_buf.resize(pad_size(size_t(size)) / sizeof(uint64_t));
+				rewind(file.get());
+				if (fread(_buf.data(), 1, size_t(size), file.get()) ==
+				    size_t(size)) {
+					_data = reinterpret_cast<uint8_t*>(_buf.data());
+					_size = size_t(size);
+				}
+			}
+		}
+#endif
+	}
+
+	~SnapshotFile() {
+#ifdef HAVE_MMAP
+		if (_data) {
+			munmap(_data, _size);
+		}
+#endif
+	}
+
+	uint8_t* data() { return _data; }
+	size_t   size() const { return _size; }
+
+private:
+	uint8_t* _data = nullptr;
+	size_t   _size = 0;
+#ifndef HAVE_MMAP
+	std::vector<uint64_t> _buf;
+#endif
+};
+
+bool
+Snapshot::load(World& world, Interface& target, const FilePath& path)
+{
+	SnapshotFile file(path);
+	if (!file.data()) {
+		world.log().error("Failed to read snapshot %1%\n", path);
+		return false;
+	}
+
+	// Check that the header matches the file
+	SnapshotHeader head{};
+	if (file.size() >= sizeof(head)) {
+		memcpy(&head, file.data(), sizeof(head));
+	}
+
+	if (memcmp(head.magic, snapshot_magic, sizeof(head.magic)) ||
+	    head.version != snapshot_version ||
+	    head.uris_size != pad_size(head.uris_size) ||
+	    sizeof(head) + head.uris_size + head.messages_size != file.size()) {
+		world.log().error("Invalid snapshot %1%\n", path);
+		return false;
+	}
+
+	// Map every URI in the table to a URID in this world
+	std::map<LV2_URID, LV2_URID> urids;
+	const uint8_t* const         table  = file.data() + sizeof(head);
+	size_t                       offset = 0;
+	for (uint32_t i = 0; i < head.n_uris; ++i) {
+		SnapshotURI entry{};
+		if (head.uris_size - offset < sizeof(entry)) {
+			world.log().error("Invalid URI table in snapshot %1%\n", path);
+			return false;
+		}
+
+		memcpy(&entry, table + offset, sizeof(entry));
+		offset += sizeof(entry);
+
+		const auto* const uri = reinterpret_cast<const char*>(table + offset);
+		if (!entry.urid || !entry.size ||
+		    head.uris_size - offset < pad_size(entry.size) ||
+		    uri[entry.size - 1] != '\0') {
+			world.log().error("Invalid URI table in snapshot %1%\n", path);
+			return false;
+		}
+
+		urids[entry.urid] = world.uri_map().map_uri(uri);
+		offset += pad_size(entry.size);
+	}
+
+	// Replace the URIDs in every message before sending any of them
+	bool valid = true;
+	auto remap = [&urids, &valid](LV2_URID& urid) {
+		if (urid) {
+			const auto u = urids.find(urid);
+			if (u != urids.end() && u->second) {
+				urid = u->second;
+			} else {
+				valid = false;
+			}
+		}
+	};
+
+	std::vector<const LV2_Atom*> msgs;
+	uint8_t* const messages = file.data() + sizeof(head) + head.uris_size;
+	for (offset = 0; offset < head.messages_size;) {
+		auto* const msg = reinterpret_cast<LV2_Atom*>(messages + offset);
+		if (!for_each_urid(world.uris().forge,
+		                   msg,
+		                   head.messages_size - offset,
+		                   remap)) {
+			world.log().error("Invalid message in snapshot %1%\n", path);
+			return false;
+		}
+
+		if (!valid) {
+			world.log().error("Unknown URID in snapshot %1%\n", path);
+			return false;
+		}
+
+		msgs.push_back(msg);
+		offset += pad_size(lv2_atom_total_size(msg));
+	}
+
+	AtomReader reader(world.uri_map(), world.uris(), world.log(), target);
+	for (const auto* msg : msgs) {
+		reader.write(msg);
+	}
+
+	return true;
+}
+
+} // namespace server
+} // namespace ingen
@@ -0,0 +1,96 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INGEN_ENGINE_SNAPSHOT_HPP
+#define INGEN_ENGINE_SNAPSHOT_HPP
+
+#include "ingen/FilePath.hpp"
+#include "raul/Noncopyable.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace ingen {
+
+class Interface;
+class Log;
+class World;
+
+namespace server {
+
+class Engine;
+class GraphImpl;
+
+/** A binary snapshot of a graph for fast restart.
+ *
+ * A snapshot is the sequence of messages that would be sent to a client to
+ * describe the graph, stored as LV2 atoms in native byte order along with a
+ * table of the URIs they use.  Loading a snapshot maps these URIs, patches
+ * the atoms in place, and replays them in a single bundle, which avoids
+ * parsing Turtle and compiles each graph only once.  Plugin state is saved
+ * as LV2 state in a directory next to the snapshot file.
+ *
+ * Snapshots are only meant to be loaded on the same machine, by the same
+ * version of Ingen, so they are not a replacement for saving a graph.
+ *
+ * \ingroup engine
+ */
+class Snapshot : public raul::Noncopyable
+{
+public:
+	/** File name extension of snapshots. */
+	static constexpr const char* const extension = ".ingensnap";
+
+	/** Describe `graph` in memory to be written to `path`.
+	 *
+	 * This reads the graph and saves the state of its plugins, so it must be
+	 * called in the pre-process thread, which is blocked until it returns.
+	 * This takes time proportional to the size of the graph, and the time
+	 * plugins take to save their state.  Writing the file is left to write(),
+	 * which may be called from another thread.
+	 */
+	Snapshot(Engine& engine, const GraphImpl& graph, FilePath path);
+
+	/** Return true if the graph was described successfully. */
+	bool is_valid() const { return _valid; }
+
+	/** Write the snapshot to its file.
+	 *
+	 * The file is replaced atomically, so an existing snapshot is never left
+	 * partially written.
+	 *
+	 * @return false if the snapshot could not be written.
+	 */
+	bool write(Log& log) const;
+
+	/** Load a snapshot from `path` and send it to `target`.
+	 *
+	 * @return false if the file is missing or is not a valid snapshot.
+	 */
+	static bool load(World& world, Interface& target, const FilePath& path);
+
+private:
+	FilePath             _path;
+	std::vector<uint8_t> _table;     ///< URI table
+	std::vector<uint8_t> _messages;  ///< Messages that describe the graph
+	uint32_t             _n_uris;    ///< Number of entries in _table
+	bool                 _valid;
+};
+
+} // namespace server
+} // namespace ingen
+
+#endif // INGEN_ENGINE_SNAPSHOT_HPP
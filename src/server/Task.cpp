@@ -17,6 +17,8 @@
 #include "Task.hpp"
 
 #include "BlockImpl.hpp"
+#include "Engine.hpp"
+#include "Profiler.hpp"
 #include "RunContext.hpp"
 
 #include "raul/Path.hpp"
@@ -32,14 +34,30 @@ Task::run(RunContext& ctx)
 	switch (_mode) {
 	case Mode::SINGLE:
 		// fprintf(stderr, "%u run %s\n", context.id(), _block->path().c_str());
-		_block->process(ctx);
+		if (_block->expendable() && ctx.engine().past_deadline(_deadline)) {
+			// Too late to finish in time, bypass to not delay anything else
+			const ProfileScope profile(
+				ctx.profiler(), ctx.id(), ProfileSpan::Kind::BLOCK, _block);
+
+			_block->pre_process(ctx);
+			_block->bypass(ctx);
+			_block->post_process(ctx);
+		} else {
+			_block->process(ctx);
+		}
 		break;
-	case Mode::SEQUENTIAL:
+	case Mode::SEQUENTIAL: {
+		const ProfileScope profile(
+			ctx.profiler(), ctx.id(), ProfileSpan::Kind::TASK, this);
+
 		for (const auto& task : _children) {
 			task->run(ctx);
 		}
-		break;
-	case Mode::PARALLEL:
+	} break;
+	case Mode::PARALLEL: {
+		const ProfileScope profile(
+			ctx.profiler(), ctx.id(), ProfileSpan::Kind::TASK, this);
+
 		// Initialize (not) done state of sub-tasks
 		for (const auto& task : _children) {
 			task->set_done(false);
@@ -58,7 +76,7 @@ Task::run(RunContext& ctx)
 			t->run(ctx);
 		}
 		ctx.claim_task(nullptr);
-		break;
+	} break;
 	}
 
 	set_done(true);
@@ -86,19 +104,30 @@ Task::get_task(RunContext& ctx)
 		return t;
 	}
 
+	Profiler& profiler   = ctx.profiler();
+	uint64_t  spin_start = 0;
 	while (true) {
 		// Push done end index as forward as possible
 		while (_done_end < _children.size() && _children[_done_end]->done()) {
 			++_done_end;
 		}
 
-		if (_done_end >= _children.size()) {
-			return nullptr;  // All child tasks are finished
+		if (_done_end >= _children.size() || (t = ctx.steal_task())) {
+			if (spin_start) {
+				profiler.record(ctx.id(),
+				                ProfileSpan::Kind::SPIN,
+				                this,
+				                spin_start,
+				                profiler.now());
+			}
+			if (t) {
+				profiler.mark(ctx.id(), ProfileSpan::Kind::STEAL, t);
+			}
+			return t;  // All child tasks are finished, or stole a task
 		}
 
-		// All child tasks claimed, but some are unfinished, steal a task
-		if ((t = ctx.steal_task())) {
-			return t;
+		if (!spin_start && profiler.enabled()) {
+			spin_start = profiler.now();
 		}
 
 		/* All child tasks are claimed, and we failed to steal any tasks.  Spin
@@ -139,6 +168,76 @@ Task::simplify(std::unique_ptr<Task>&& task)
 	return ret;
 }
 
+std::unique_ptr<Task>
+Task::split(std::unique_ptr<Task>&& task, unsigned n_stages)
+{
+	assert(task->mode() == Mode::SEQUENTIAL);
+
+	Children& children = task->_children;
+	n_stages = std::min(n_stages, unsigned(children.size()));
+
+	std::unique_ptr<Task> ret = std::unique_ptr<Task>(new Task(Mode::PARALLEL));
+	size_t                remaining = task->num_blocks();
+	size_t                i         = 0;
+	for (unsigned s = 0; s < n_stages; ++s) {
+		// Leave at least one child for each later stage
+		const unsigned later = n_stages - s - 1;
+		const size_t   share = (remaining + later) / (later + 1);
+
+		std::unique_ptr<Task> stage(new Task(Mode::SEQUENTIAL));
+		size_t                n = 0;
+		while (i < children.size() - later) {
+			const size_t c = children[i]->num_blocks();
+			if (later && n > 0 && n + c > share) {
+				break;
+			}
+
+			n += c;
+			stage->append(std::move(children[i++]));
+		}
+
+		remaining -= n;
+		ret->append(std::move(stage));
+	}
+
+	return ret;
+}
+
+float
+Task::prioritize(const std::function<float(const BlockImpl*)>& deadline)
+{
+	if (_mode == Mode::SINGLE) {
+		return (_deadline = deadline(_block));
+	}
+
+	_deadline = 1.0f;
+	for (auto& c : _children) {
+		_deadline = std::min(_deadline, c->prioritize(deadline));
+	}
+
+	if (_mode == Mode::PARALLEL) {
+		// Children are stolen in order, so put the most urgent first
+		std::stable_sort(_children.begin(),
+		                 _children.end(),
+		                 [](const std::unique_ptr<Task>& a,
+		                    const std::unique_ptr<Task>& b) {
+			                 return a->_deadline < b->_deadline;
+		                 });
+	}
+
+	return _deadline;
+}
+
+size_t
+Task::num_blocks() const
+{
+	size_t n = (_mode == Mode::SINGLE) ? 1 : 0;
+	for (const auto& c : _children) {
+		n += c->num_blocks();
+	}
+	return n;
+}
+
 void
 Task::dump(const std::function<void(const std::string&)>& sink,
            unsigned                                       indent,
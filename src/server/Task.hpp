@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -43,6 +44,7 @@ public:
 	Task(Mode mode, BlockImpl* block = nullptr)
 		: _block(block)
 		, _mode(mode)
+		, _deadline(1.0f)
 		, _done_end(0)
 		, _next(0)
 		, _done(false)
@@ -57,6 +59,7 @@ public:
 		: _children(std::move(task._children))
 		, _block(task._block)
 		, _mode(task._mode)
+		, _deadline(task._deadline)
 		, _done_end(task._done_end)
 		, _next(task._next.load())
 		, _done(task._done.load())
@@ -67,6 +70,7 @@ public:
 		_children = std::move(task._children);
 		_block    = task._block;
 		_mode     = task._mode;
+		_deadline = task._deadline;
 		_done_end = task._done_end;
 		_next     = task._next.load();
 		_done     = task._done.load();
@@ -87,6 +91,40 @@ public:
 	/** Simplify task expression. */
 	static std::unique_ptr<Task> simplify(std::unique_ptr<Task>&& task);
 
+	/** Split a sequential task into a parallel task of sequential stages.
+	 *
+	 * The children of the given task are divided into at most `n_stages`
+	 * contiguous stages with roughly equal numbers of blocks, which are the
+	 * children of the returned task in order.  Running the stages in parallel
+	 * is only correct if data flowing between them is delayed.
+	 */
+	static std::unique_ptr<Task> split(std::unique_ptr<Task>&& task,
+	                                   unsigned                n_stages);
+
+	/** Set the deadline of every block with `deadline` (recursively).
+	 *
+	 * A deadline is the fraction of a cycle that a block should be finished
+	 * by.  The children of parallel tasks are sorted by their earliest
+	 * deadline, so that the most urgent ones are run first.
+	 *
+	 * @return The earliest deadline of any block in this task.
+	 */
+	float prioritize(const std::function<float(const BlockImpl*)>& deadline);
+
+	/** Return the number of blocks in this task (recursively). */
+	size_t num_blocks() const;
+
+	/** Call `f` with every block in this task (recursively). */
+	template<typename F>
+	void for_each_block(F f) const {
+		if (_mode == Mode::SINGLE) {
+			f(_block);
+		}
+		for (const auto& c : _children) {
+			c->for_each_block(f);
+		}
+	}
+
 	/** Steal a child task from this task (succeeds for PARALLEL only). */
 	Task* steal(RunContext& ctx);
 
@@ -95,9 +133,12 @@ public:
 		_children.emplace_front(std::unique_ptr<Task>(new Task(std::move(task))));
 	}
 
-	Mode       mode()  const { return _mode; }
-	BlockImpl* block() const { return _block; }
-	bool       done()  const { return _done; }
+	size_t      size()          const { return _children.size(); }
+	const Task& child(size_t i) const { return *_children[i]; }
+	Mode        mode()          const { return _mode; }
+	BlockImpl*  block()         const { return _block; }
+	float       deadline()      const { return _deadline; }
+	bool        done()          const { return _done; }
 
 	void set_done(bool done) { _done = done; }
 
@@ -113,6 +154,7 @@ private:
 	Children              _children;  ///< Vector of child tasks
 	BlockImpl*            _block;     ///< Used for SINGLE only
 	Mode                  _mode;      ///< Execution mode
+	float                 _deadline;  ///< Earliest deadline, fraction of cycle
 	unsigned              _done_end;  ///< Index of rightmost done sub-task
 	std::atomic<unsigned> _next;      ///< Index of next sub-task
 	std::atomic<bool>     _done;      ///< Completion phase
@@ -24,9 +24,11 @@
 #include "serd/serd.h"
 #include "sratom/sratom.h"
 
+#include <cstring>
 #include <ctime>
 #include <iterator>
 #include <memory>
+#include <utility>
 
 #define NS_RDF "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
 
@@ -35,13 +37,25 @@
 namespace ingen {
 namespace server {
 
+void
+UndoStack::Entry::push_event(const LV2_Atom* ev)
+{
+	const uint32_t size   = lv2_atom_total_size(ev);
+	const size_t   offset = _data.size();
+
+	_data.resize(offset + (size + sizeof(uint64_t) - 1U) / sizeof(uint64_t));
+	memcpy(_data.data() + offset, ev, size);
+	_offsets.push_back(uint32_t(offset));
+}
+
 int
 UndoStack::start_entry()
 {
 	if (_depth == 0) {
 		time_t now = {};
 		time(&now);
-		_stack.emplace_back(Entry(now));
+		_stack.emplace_back(now);
+		_memory += _stack.back().memory();
 	}
 	return ++_depth;
 }
@@ -49,7 +63,11 @@ UndoStack::start_entry()
 bool
 UndoStack::write(const LV2_Atom* msg, int32_t)
 {
-	_stack.back().push_event(msg);
+	Entry&       entry  = _stack.back();
+	const size_t before = entry.memory();
+
+	entry.push_event(msg);
+	_memory += entry.memory() - before;
 	return true;
 }
 
@@ -83,23 +101,53 @@ UndoStack::ignore_later_event(const LV2_Atom* first,
 	return false;
 }
 
+bool
+UndoStack::ignore_later_entry(const Entry& first, const Entry& second) const
+{
+	/* The later entry is redundant if every event in it sets something which
+	   the earlier entry already restores to an older value.  This merges
+	   continuous control changes, including several controls changed at once
+	   in a bundle, into a single entry. */
+	for (size_t i = 0; i < second.size(); ++i) {
+		bool ignore = false;
+		for (size_t j = 0; j < first.size() && !ignore; ++j) {
+			ignore = ignore_later_event(first.event(j), second.event(i));
+		}
+
+		if (!ignore) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 int
 UndoStack::finish_entry()
 {
 	if (--_depth > 0) {
 		return _depth;
-	} else if (_stack.back().events.empty()) {
+	} else if (_stack.back().empty()) {
 		// Disregard empty entry
+		_memory -= _stack.back().memory();
 		_stack.pop_back();
-	} else if (_stack.size() > 1 && _stack.back().events.size() == 1) {
-		// This entry and the previous one have one event, attempt to merge
-		auto i = _stack.rbegin();
-		++i;
-		if (i->events.size() == 1) {
-			if (ignore_later_event(i->events[0], _stack.back().events[0])) {
-				_stack.pop_back();
-			}
-		}
+	} else if (_stack.size() > 1 &&
+	           ignore_later_entry(*std::next(_stack.rbegin()), _stack.back())) {
+		// Previous entry already undoes this one, so merge them
+		_memory -= _stack.back().memory();
+		_stack.pop_back();
+	} else {
+		Entry&       entry  = _stack.back();
+		const size_t before = entry.memory();
+
+		entry.shrink();
+		_memory -= before - entry.memory();
+	}
+
+	// Discard the oldest entries if over the memory limit
+	while (_max_memory && _memory > _max_memory && _stack.size() > 1) {
+		_memory -= _stack.front().memory();
+		_stack.pop_front();
 	}
 
 	return _depth;
@@ -110,7 +158,8 @@ UndoStack::pop()
 {
 	Entry top;
 	if (!_stack.empty()) {
-		top = _stack.back();
+		_memory -= _stack.back().memory();
+		top = std::move(_stack.back());
 		_stack.pop_back();
 	}
 	return top;
@@ -198,8 +247,9 @@ UndoStack::write_entry(Sratom*                 sratom,
 	BlankIDs    ids('e');
 	ListContext ctx(ids, SERD_ANON_CONT, subject, &p);
 
-	for (const LV2_Atom* atom : entry.events) {
-		const SerdNode node = ctx.start_node(writer);
+	for (size_t i = 0; i < entry.size(); ++i) {
+		const LV2_Atom* const atom = entry.event(i);
+		const SerdNode        node = ctx.start_node(writer);
 
 		p = serd_node_from_string(SERD_URI,
 		                          reinterpret_cast<const uint8_t*>(NS_RDF
@@ -20,17 +20,16 @@
 #include "ingen/AtomSink.hpp"
 #include "ingen/ingen.h"
 #include "lv2/atom/atom.h"
-#include "lv2/atom/util.h"
 #include "serd/serd.h"
 #include "sratom/sratom.h"
 
-#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
-#include <cstdlib>
-#include <cstring>
 #include <ctime>
 #include <deque>
+#include <vector>
 
 namespace ingen {
 
@@ -39,51 +38,67 @@ class URIs;
 
 namespace server {
 
+/** A stack of entries which undo changes to the engine.
+ *
+ * Consecutive entries which only set properties that the previous entry
+ * already restores are merged, so continuously tweaking controls does not
+ * grow the history.  If a memory limit is given, the oldest entries are
+ * discarded to stay within it.
+ *
+ * \ingroup engine
+ */
 class INGEN_API UndoStack : public AtomSink {
 public:
+	/** Events which undo a single change, in the order they must be applied.
+	 *
+	 * Events are stored contiguously, each padded to 64 bits, so an entry
+	 * needs only a couple of allocations regardless of how many events it
+	 * has.
+	 */
 	struct Entry {
-		Entry(time_t t=0) : time(t) {}
-
-		Entry(const Entry& copy)
-			: time(copy.time)
-		{
-			for (const LV2_Atom* ev : copy.events) {
-				push_event(ev);
-			}
-		}
+		explicit Entry(time_t t=0) : time(t) {}
+
+		/** Add a copy of an event which must be applied before the others. */
+		void push_event(const LV2_Atom* ev);
+
+		/** Return the number of events. */
+		size_t size() const { return _offsets.size(); }
+
+		/** Return true iff this entry has no events. */
+		bool empty() const { return _offsets.empty(); }
 
-		~Entry() { clear(); }
-
-		Entry& operator=(const Entry& rhs) {
-			if (&rhs != this) {
-				clear();
-				time = rhs.time;
-				for (const LV2_Atom* ev : rhs.events) {
-					push_event(ev);
-				}
-			}
-			return *this;
+		/** Return the `i`th event to apply. */
+		const LV2_Atom* event(size_t i) const {
+			return reinterpret_cast<const LV2_Atom*>(
+				_data.data() + _offsets[_offsets.size() - 1 - i]);
 		}
 
-		void clear() {
-			for (LV2_Atom* ev : events) {
-				free(ev);
-			}
-			events.clear();
+		/** Return the memory used by this entry in bytes. */
+		size_t memory() const {
+			return sizeof(Entry) + _data.capacity() * sizeof(uint64_t) +
+			       _offsets.capacity() * sizeof(uint32_t);
 		}
 
-		void push_event(const LV2_Atom* ev) {
-			const uint32_t size = lv2_atom_total_size(ev);
-			auto*          copy = static_cast<LV2_Atom*>(malloc(size));
-			memcpy(copy, ev, size);
-			events.push_front(copy);
+		/** Release unused memory once the entry is complete. */
+		void shrink() {
+			_data.shrink_to_fit();
+			_offsets.shrink_to_fit();
 		}
 
-		time_t                time;
-		std::deque<LV2_Atom*> events;
+		time_t time;
+
+	private:
+		std::vector<uint64_t> _data;     ///< Events in the order pushed
+		std::vector<uint32_t> _offsets;  ///< Offset of each event in words
 	};
 
-	UndoStack(URIs& uris, URIMap& map) : _uris(uris), _map(map), _depth(0) {}
+	/** Create an undo stack.
+	 *
+	 * @param max_memory Memory limit in bytes, or zero for no limit.
+	 */
+	UndoStack(URIs& uris, URIMap& map, size_t max_memory=0)
+		: _uris(uris), _map(map), _max_memory(max_memory), _memory(0), _depth(0)
+	{}
 
 	int  start_entry();
 	bool write(const LV2_Atom* msg, int32_t default_id=0) override;
@@ -92,21 +107,28 @@ public:
 	bool  empty() const { return _stack.empty(); }
 	Entry pop();
 
+	/** Return the memory used by all entries in bytes (thread safe). */
+	size_t memory() const { return _memory; }
+
 	void save(FILE* stream, const char* name="undo");
 
 private:
 	bool ignore_later_event(const LV2_Atom* first,
 	                        const LV2_Atom* second) const;
 
+	bool ignore_later_entry(const Entry& first, const Entry& second) const;
+
 	void write_entry(Sratom*         sratom,
 	                 SerdWriter*     writer,
 	                 const SerdNode* subject,
 	                 const Entry&    entry);
 
-	URIs&             _uris;
-	URIMap&           _map;
-	std::deque<Entry> _stack;
-	int               _depth;
+	URIs&               _uris;
+	URIMap&             _map;
+	std::deque<Entry>   _stack;
+	const size_t        _max_memory;
+	std::atomic<size_t> _memory;
+	int                 _depth;
 };
 
 } // namespace server
@@ -20,12 +20,20 @@
 #include "GraphImpl.hpp"
 #include "LV2Block.hpp"
 
+#include "ingen/Forge.hpp"
 #include "ingen/Log.hpp"
 #include "ingen/Node.hpp"
+#include "ingen/URIs.hpp"
 #include "lv2/core/lv2.h"
 #include "lv2/worker/worker.h"
 
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 
 namespace ingen {
@@ -34,22 +42,14 @@ class World;
 
 namespace server {
 
-/// A message in the Worker::_requests ring
-struct MessageHeader {
-	LV2Block* block;  ///< Node this message is from
-	uint32_t  size;  ///< Size of following data
-	// `size' bytes of data follow here
-};
-
 static LV2_Worker_Status
 schedule(LV2_Worker_Schedule_Handle handle,
          uint32_t                   size,
          const void*                data)
 {
-	auto*   block  = static_cast<LV2Block*>(handle);
-	Engine& engine = block->parent_graph()->engine();
+	auto* queue = static_cast<Worker::Queue*>(handle);
 
-	return engine.worker()->request(block, size, data);
+	return queue->worker.request(*queue, size, data);
 }
 
 static LV2_Worker_Status
@@ -57,37 +57,41 @@ schedule_sync(LV2_Worker_Schedule_Handle handle,
               uint32_t                   size,
               const void*                data)
 {
-	auto*   block  = static_cast<LV2Block*>(handle);
-	Engine& engine = block->parent_graph()->engine();
+	auto* block = static_cast<LV2Block*>(handle);
 
-	return engine.sync_worker()->request(block, size, data);
+	return block->work(size, data);
 }
 
 LV2_Worker_Status
-Worker::request(LV2Block*   block,
-                uint32_t    size,
-                const void* data)
+Worker::request(Queue& queue, uint32_t size, const void* data)
 {
 	if (_synchronous) {
-		return block->work(size, data);
+		return queue.block->work(size, data);
 	}
 
-	Engine& engine = block->parent_graph()->engine();
-	if (_requests.write_space() < sizeof(MessageHeader) + size) {
-		engine.log().error("Work request ring overflow\n");
+	raul::RingBuffer& requests = queue.requests;
+	if (size > _buffer_size ||
+	    requests.write_space() < sizeof(MessageHeader) + size) {
+		_log.error("Work request ring overflow\n");
 		return LV2_WORKER_ERR_NO_SPACE;
 	}
 
-	const MessageHeader msg = { block, size };
-	if (_requests.write(sizeof(msg), &msg) != sizeof(msg)) {
-		engine.log().error("Error writing header to work request ring\n");
+	const MessageHeader msg = { _clock.now_nanoseconds(), size };
+	if (requests.write(sizeof(msg), &msg) != sizeof(msg)) {
+		_log.error("Error writing header to work request ring\n");
 		return LV2_WORKER_ERR_UNKNOWN;
 	}
-	if (_requests.write(size, data) != size) {
-		engine.log().error("Error writing body to work request ring\n");
+	if (requests.write(size, data) != size) {
+		_log.error("Error writing body to work request ring\n");
 		return LV2_WORKER_ERR_UNKNOWN;
 	}
 
+	// Only the block's run thread updates max_depth, so this is exact
+	const uint32_t depth = ++queue.depth;
+	if (depth > queue.max_depth) {
+		queue.max_depth = depth;
+	}
+
 	_sem.post();
 
 	return LV2_WORKER_SUCCESS;
@@ -103,67 +107,202 @@ Worker::Schedule::feature(World&, Node* n)
 
 	auto* data = static_cast<LV2_Worker_Schedule*>(malloc(sizeof(LV2_Worker_Schedule)));
 
-	data->handle        = block;
-	data->schedule_work = synchronous ? schedule_sync : schedule;
-
 	auto* f = static_cast<LV2_Feature*>(malloc(sizeof(LV2_Feature)));
 	f->URI  = LV2_WORKER__schedule;
 	f->data = data;
 
-	return std::shared_ptr<LV2_Feature>(f, &free_feature);
+	if (synchronous) {
+		data->handle        = block;
+		data->schedule_work = schedule_sync;
+		return std::shared_ptr<LV2_Feature>(f, &free_feature);
+	}
+
+	Queue* queue        = worker.add_queue(block);
+	data->handle        = queue;
+	data->schedule_work = schedule;
+
+	return std::shared_ptr<LV2_Feature>(f, [queue](LV2_Feature* feature) {
+		queue->worker.remove_queue(queue);
+		free_feature(feature);
+	});
 }
 
-Worker::Worker(Log& log, uint32_t buffer_size, bool synchronous)
-	: _schedule(new Schedule(synchronous))
+Worker::Worker(Log&     log,
+               uint32_t buffer_size,
+               bool     synchronous,
+               unsigned n_threads,
+               int      priority)
+	: _schedule(new Schedule(*this, synchronous))
 	, _log(log)
 	, _sem(0)
-	, _requests(buffer_size)
-	, _responses(buffer_size)
-	, _buffer(static_cast<uint8_t*>(malloc(buffer_size)))
+	, _next(0)
 	, _buffer_size(buffer_size)
-	, _thread(nullptr)
 	, _exit_flag(false)
 	, _synchronous(synchronous)
 {
-	if (!synchronous) {
-		_thread = std::make_unique<std::thread>(&Worker::run, this);
+	if (synchronous) {
+		return;
+	}
+
+	for (unsigned i = 0; i < std::max(n_threads, 1U); ++i) {
+		_threads.emplace_back(&Worker::run, this);
+
+		if (priority > 0) {
+			sched_param sp{};
+			sp.sched_priority = priority;
+			if (pthread_setschedparam(
+				    _threads.back().native_handle(), SCHED_FIFO, &sp)) {
+				_log.error("Failed to set priority of worker thread (%s)\n",
+				           strerror(errno));
+			}
+		}
 	}
 }
 
 Worker::~Worker()
 {
 	_exit_flag = true;
-	_sem.post();
-	if (_thread) {
-		_thread->join();
+	for (size_t i = 0; i < _threads.size(); ++i) {
+		_sem.post();
+	}
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+
+	for (Queue* queue : _queues) {
+		delete queue;
+	}
+}
+
+Worker::Queue*
+Worker::add_queue(LV2Block* block)
+{
+	// Room for the header and a maximum size body, preallocated here so
+	// scheduling work never allocates (a ring always keeps one byte free)
+	auto* queue = new Queue(
+		*this, block, uint32_t(sizeof(MessageHeader)) + _buffer_size + 1U);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_queues.push_back(queue);
+	return queue;
+}
+
+void
+Worker::remove_queue(Queue* queue)
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		const auto i = std::find(_queues.begin(), _queues.end(), queue);
+		if (i == _queues.end()) {
+			return;
+		}
+
+		_queues.erase(i);
+		if (_next >= _queues.size()) {
+			_next = 0;
+		}
+
+		// No thread can claim the queue now, but one may still be serving it
+		_idle.wait(lock, [queue] { return !queue->busy; });
+	}
+
+	delete queue;
+}
+
+Worker::Queue*
+Worker::claim_queue()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const size_t n_queues = _queues.size();
+	for (size_t i = 0; i < n_queues; ++i) {
+		const size_t index = (_next + i) % n_queues;
+		Queue* const queue = _queues[index];
+		if (queue->depth && !queue->busy.exchange(true)) {
+			_next = (index + 1) % n_queues;
+			return queue;
+		}
+	}
+
+	return nullptr;
+}
+
+void
+Worker::serve(Queue& queue, uint8_t* buffer)
+{
+	MessageHeader msg{};
+	if (queue.requests.read(sizeof(msg), &msg) != sizeof(msg)) {
+		_log.error("Error reading header from work request ring\n");
+	} else if (msg.size > _buffer_size) {
+		_log.error("Corrupt work request ring\n");
+	} else if (queue.requests.read(msg.size, buffer) != msg.size) {
+		_log.error("Error reading body from work request ring\n");
+	} else {
+		queue.block->work(msg.size, buffer);
+
+		// Any responses have been queued by the time work() returns
+		const uint64_t latency = _clock.now_nanoseconds() - msg.time;
+		++queue.count;
+		queue.total += latency;
+		if (latency > queue.max) {
+			queue.max = latency;
+		}
 	}
-	free(_buffer);
+
+	--queue.depth;
+
+	{
+		// Release under the lock so remove_queue() can not miss the change
+		std::lock_guard<std::mutex> lock(_mutex);
+		queue.busy = false;
+	}
+	_idle.notify_all();
 }
 
 void
 Worker::run()
 {
-	while (_sem.wait() && !_exit_flag) {
-		MessageHeader msg{};
-		if (_requests.read_space() > sizeof(msg)) {
-			if (_requests.read(sizeof(msg), &msg) != sizeof(msg)) {
-				_log.error("Error reading header from work request ring\n");
-				continue;
-			}
+	std::unique_ptr<uint8_t[]> buffer(new uint8_t[_buffer_size]);
 
-			if (msg.size >= _buffer_size - sizeof(msg)) {
-				_log.error("Corrupt work request ring\n");
+	while (_sem.wait() && !_exit_flag) {
+		/* Serve one request from each ready queue in turn until there is
+		   nothing left this thread can claim.  A queue being served by
+		   another thread will be drained by that thread, so waking for a
+		   request which has already been handled is harmless. */
+		while (Queue* queue = claim_queue()) {
+			serve(*queue, buffer.get());
+			if (_exit_flag) {
 				return;
 			}
+		}
+	}
+}
 
-			if (_requests.read(msg.size, _buffer) != msg.size) {
-				_log.error("Error reading body from work request ring\n");
-				continue;
-			}
+Properties
+Worker::properties(const URIs& uris, const LV2Block* block) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
 
-			msg.block->work(msg.size, _buffer);
-		}
+	const auto i = std::find_if(
+		_queues.begin(), _queues.end(), [block](const Queue* q) {
+			return q->block == block;
+		});
+
+	if (i == _queues.end() || (!(*i)->count && !(*i)->depth)) {
+		return Properties();
 	}
+
+	const Queue&  queue = **i;
+	const int64_t count = static_cast<int64_t>(queue.count);
+	const float   mean  = count ? queue.total / 1000.0f / count : 0.0f;
+	const float   max   = queue.max / 1000.0f;
+
+	return { { uris.ingen_workCount,
+	           Forge::alloc(sizeof(count), uris.forge.Long, &count) },
+	         { uris.ingen_workLatency, uris.forge.make(mean) },
+	         { uris.ingen_maxWorkLatency, uris.forge.make(max) },
+	         { uris.ingen_maxQueueDepth,
+	           uris.forge.make(int32_t(queue.max_depth)) } };
 }
 
 } // namespace server
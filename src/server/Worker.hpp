@@ -17,62 +17,120 @@
 #ifndef INGEN_ENGINE_WORKER_HPP
 #define INGEN_ENGINE_WORKER_HPP
 
+#include "ingen/Clock.hpp"
 #include "ingen/LV2Features.hpp"
+#include "ingen/Properties.hpp"
 #include "lv2/core/lv2.h"
 #include "lv2/worker/worker.h"
 #include "raul/RingBuffer.hpp"
 #include "raul/Semaphore.hpp"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 namespace ingen {
 
 class Log;
 class Node;
+class URIs;
 class World;
 
 namespace server {
 
 class LV2Block;
 
+/** Pool of threads which run the work method of LV2 plugins.
+ *
+ * Each block gets its own request queue when its schedule feature is created,
+ * so a plugin doing slow work (like loading a sample) only delays its own
+ * requests.  Worker threads serve queues round-robin, one request at a time,
+ * and a queue is only ever served by one thread at once so each block sees its
+ * requests in order.
+ *
+ * \ingroup engine
+ */
 class Worker
 {
 public:
-	Worker(Log& log, uint32_t buffer_size, bool synchronous=false);
+	Worker(Log&     log,
+	       uint32_t buffer_size,
+	       bool     synchronous = false,
+	       unsigned n_threads   = 1,
+	       int      priority    = 0);
+
 	~Worker();
 
+	/** Request queue and statistics for a single block. */
+	struct Queue {
+		Queue(Worker& w, LV2Block* b, uint32_t size)
+			: worker(w), block(b), requests(size)
+		{}
+
+		Worker&               worker;
+		LV2Block* const       block;
+		raul::RingBuffer      requests;
+		std::atomic<bool>     busy{false};   ///< Being served by a thread
+		std::atomic<uint32_t> depth{0};      ///< Number of pending requests
+		std::atomic<uint32_t> max_depth{0};  ///< Maximum number of requests
+		std::atomic<uint64_t> count{0};      ///< Number of requests served
+		std::atomic<uint64_t> total{0};      ///< Total latency in nanoseconds
+		std::atomic<uint64_t> max{0};        ///< Maximum latency in nanoseconds
+	};
+
 	struct Schedule : public LV2Features::Feature {
-		Schedule(bool sync) : synchronous(sync) {}
+		Schedule(Worker& w, bool sync) : worker(w), synchronous(sync) {}
 
 		const char* uri() const override { return LV2_WORKER__schedule; }
 
 		std::shared_ptr<LV2_Feature> feature(World& world, Node* n) override;
 
+		Worker&    worker;
 		const bool synchronous;
 	};
 
-	LV2_Worker_Status request(LV2Block*   block,
-	                          uint32_t    size,
-	                          const void* data);
+	/** Queue a work request from a block (realtime safe). */
+	LV2_Worker_Status request(Queue& queue, uint32_t size, const void* data);
+
+	/** Return work statistics for a block as properties.
+	 *
+	 * This is empty if the block has no queue or has never scheduled work.
+	 */
+	Properties properties(const URIs& uris, const LV2Block* block) const;
 
 	std::shared_ptr<Schedule> schedule_feature() { return _schedule; }
 
 private:
+	/// A message in a Queue::requests ring
+	struct MessageHeader {
+		uint64_t time;  ///< Time of request in nanoseconds
+		uint32_t size;  ///< Size of following data
+		// `size' bytes of data follow here
+	};
+
+	Queue* add_queue(LV2Block* block);
+	void   remove_queue(Queue* queue);
+	Queue* claim_queue();
+	void   serve(Queue& queue, uint8_t* buffer);
+	void   run();
+
 	std::shared_ptr<Schedule> _schedule;
 
-	Log&                         _log;
-	raul::Semaphore              _sem;
-	raul::RingBuffer             _requests;
-	raul::RingBuffer             _responses;
-	uint8_t* const               _buffer;
-	const uint32_t               _buffer_size;
-	std::unique_ptr<std::thread> _thread;
-	bool                         _exit_flag;
-	bool                         _synchronous;
-
-	void run();
+	Log&                      _log;
+	Clock                     _clock;
+	raul::Semaphore           _sem;
+	mutable std::mutex        _mutex;   ///< Protects _queues and _next
+	std::condition_variable   _idle;    ///< Notified when a queue is released
+	std::vector<Queue*>       _queues;
+	size_t                    _next;    ///< Index of next queue to serve
+	const uint32_t            _buffer_size;
+	std::vector<std::thread>  _threads;
+	std::atomic<bool>         _exit_flag;
+	bool                      _synchronous;
 };
 
 } // namespace server
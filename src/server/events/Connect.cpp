@@ -150,8 +150,9 @@ Connect::pre_process(PreProcessContext& ctx)
 
 	if (!_head->is_driver_port()) {
 		BufferFactory& bufs = *_engine.buffer_factory();
-		_voices = bufs.maid().make_managed<PortImpl::Voices>(_head->poly());
-		_head->pre_get_buffers(bufs, _voices, _head->poly());
+		_voices = bufs.maid().make_managed<PortImpl::Voices>(
+			_head->allocated_poly());
+		_head->pre_get_buffers(bufs, _voices, _head->allocated_poly());
 	}
 
 	tail_output->inherit_neighbour(_head, _tail_remove, _tail_add);
@@ -22,7 +22,10 @@
 #include "Engine.hpp"
 #include "GraphImpl.hpp"
 #include "PreProcessContext.hpp"
+#include "Snapshot.hpp"
 
+#include "ingen/FilePath.hpp"
+#include "ingen/Log.hpp"
 #include "ingen/Interface.hpp"
 #include "ingen/Parser.hpp"
 #include "ingen/Serialiser.hpp"
@@ -160,6 +163,16 @@ Copy::engine_to_filesystem(PreProcessContext&)
 		return Event::pre_process_done(Status::BAD_OBJECT_TYPE, _msg.old_uri);
 	}
 
+	if (ends_with(_msg.new_uri, Snapshot::extension)) {
+		// Describe the graph now, but write the file later in post_process()
+		std::lock_guard<std::mutex> lock(_engine.world().rdf_mutex());
+		_snapshot = std::make_unique<Snapshot>(
+			_engine, *graph, _msg.new_uri.file_path());
+		return Event::pre_process_done(_snapshot->is_valid()
+		                               ? Status::SUCCESS
+		                               : Status::INTERNAL_ERROR);
+	}
+
 	if (!_engine.world().serialiser()) {
 		return Event::pre_process_done(Status::INTERNAL_ERROR);
 	}
@@ -181,6 +194,22 @@ Copy::engine_to_filesystem(PreProcessContext&)
 bool
 Copy::filesystem_to_engine(PreProcessContext&)
 {
+	if (ends_with(_msg.old_uri, Snapshot::extension)) {
+		// Snapshots restore a whole engine at the paths they were taken from
+		if (!uri_to_path(_msg.new_uri).is_root()) {
+			return Event::pre_process_done(Status::BAD_REQUEST, _msg.new_uri);
+		}
+
+		std::lock_guard<std::mutex> lock(_engine.world().rdf_mutex());
+		return Event::pre_process_done(
+			Snapshot::load(_engine.world(),
+			               *_engine.world().interface(),
+			               _msg.old_uri.file_path())
+			? Status::SUCCESS
+			: Status::NOT_FOUND,
+			_msg.old_uri);
+	}
+
 	if (!_engine.world().parser()) {
 		return Event::pre_process_done(Status::INTERNAL_ERROR);
 	}
@@ -215,6 +244,11 @@ Copy::execute(RunContext&)
 void
 Copy::post_process()
 {
+	if (_snapshot && _status == Status::SUCCESS &&
+	    !_snapshot->write(_engine.world().log())) {
+		_status = Status::INTERNAL_ERROR;
+	}
+
 	Broadcaster::Transfer t(*_engine.broadcaster());
 	if (respond() == Status::SUCCESS) {
 		_engine.broadcaster()->message(_msg);
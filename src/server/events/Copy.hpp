@@ -37,6 +37,7 @@ class Engine;
 class GraphImpl;
 class PreProcessContext;
 class RunContext;
+class Snapshot;
 
 namespace events {
 
@@ -68,6 +69,7 @@ private:
 	GraphImpl*                       _parent;
 	BlockImpl*                       _block;
 	raul::managed_ptr<CompiledGraph> _compiled_graph;
+	std::unique_ptr<Snapshot>        _snapshot;
 };
 
 } // namespace events
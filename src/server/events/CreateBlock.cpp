@@ -18,6 +18,7 @@
 
 #include "BlockFactory.hpp"
 #include "BlockImpl.hpp"
+#include "BlockPool.hpp"
 #include "Broadcaster.hpp"
 #include "CompiledGraph.hpp"
 #include "Engine.hpp"
@@ -66,6 +67,7 @@ CreateBlock::CreateBlock(Engine&                           engine,
     , _properties(properties)
     , _graph(nullptr)
     , _block(nullptr)
+    , _apply_poly(false)
 {}
 
 CreateBlock::~CreateBlock() = default;
@@ -145,19 +147,38 @@ CreateBlock::pre_process(PreProcessContext& ctx)
 				_engine.world(), FilePath(s->second.ptr<char>()));
 		}
 
-		// Instantiate plugin
-		if (!(_block = plugin->instantiate(*_engine.buffer_factory(),
-		                                   raul::Symbol(_path.symbol()),
-		                                   polyphonic,
-		                                   _graph,
-		                                   _engine,
-		                                   state.get()))) {
+		// Take a spare instance with default state if possible
+		const raul::Symbol symbol(_path.symbol());
+		BlockPool&         pool = *_engine.block_pool();
+		if (!state && !polyphonic) {
+			_block = pool.take(*plugin, symbol, _graph);
+		}
+
+		// Otherwise, instantiate plugin
+		if (!_block && !(_block = plugin->instantiate(*_engine.buffer_factory(),
+		                                              symbol,
+		                                              polyphonic,
+		                                              _graph,
+		                                              _engine,
+		                                              state.get()))) {
 			return Event::pre_process_done(Status::CREATION_FAILED, _path);
 		}
+
+		pool.use(*plugin);
 	}
 
-	// Activate block
 	_block->properties().insert(_properties.begin(), _properties.end());
+
+	// Share one instance between voices if requested, or inherited
+	auto* const lv2_block = dynamic_cast<LV2Block*>(_block);
+	const Atom& shared    = _block->get_property(uris.ingen_sharedInstance);
+	if (lv2_block && shared.type() == uris.forge.Bool) {
+		lv2_block->set_shared_instance(shared.get<int32_t>());
+		_apply_poly = lv2_block->prepare_poly(*_engine.buffer_factory(),
+		                                      lv2_block->polyphony());
+	}
+
+	// Activate block
 	_block->activate(*_engine.buffer_factory());
 
 	// Add block to the store and the graph's pre-processor only block list
@@ -175,8 +196,12 @@ CreateBlock::pre_process(PreProcessContext& ctx)
 }
 
 void
-CreateBlock::execute(RunContext&)
+CreateBlock::execute(RunContext& ctx)
 {
+	if (_status == Status::SUCCESS && _apply_poly) {
+		_block->apply_poly(ctx, _block->polyphony());
+	}
+
 	if (_status == Status::SUCCESS && _compiled_graph) {
 		_graph->set_compiled_graph(std::move(_compiled_graph));
 	}
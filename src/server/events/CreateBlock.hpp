@@ -71,6 +71,7 @@ private:
 	GraphImpl*                       _graph;
 	BlockImpl*                       _block;
 	raul::managed_ptr<CompiledGraph> _compiled_graph;
+	bool                             _apply_poly;
 };
 
 } // namespace events
@@ -29,6 +29,7 @@
 #include "GraphImpl.hpp"
 #include "PortImpl.hpp"
 #include "PreProcessContext.hpp"
+#include "Profiler.hpp"
 
 #include "ingen/Forge.hpp"
 #include "ingen/Interface.hpp"
@@ -204,6 +205,10 @@ Delete::post_process()
 		_engine.driver()->unregister_port(*_engine_port);
 		delete _engine_port;
 	}
+
+	for (const auto& o : _removed_objects) {
+		_engine.profiler()->forget(o.second.get());
+	}
 }
 
 void
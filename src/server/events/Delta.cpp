@@ -24,12 +24,15 @@
 #include "CreateBlock.hpp"
 #include "CreateGraph.hpp"
 #include "CreatePort.hpp"
+#include "DuplexPort.hpp"
 #include "Engine.hpp"
 #include "GraphImpl.hpp"
+#include "LV2Block.hpp"
 #include "NodeImpl.hpp"
 #include "PluginImpl.hpp"
 #include "PortImpl.hpp"
 #include "PortType.hpp"
+#include "Profiler.hpp"
 #include "SetPortValue.hpp"
 
 #include "ingen/Atom.hpp"
@@ -74,6 +77,7 @@ Delta::Delta(Engine&                           engine,
 	, _properties(msg.properties)
 	, _object(nullptr)
 	, _graph(nullptr)
+	, _deadline_port(nullptr)
 	, _binding(nullptr)
 	, _state()
 	, _context(msg.ctx)
@@ -94,6 +98,7 @@ Delta::Delta(Engine&                           engine,
 	, _remove(msg.remove)
 	, _object(nullptr)
 	, _graph(nullptr)
+	, _deadline_port(nullptr)
 	, _binding(nullptr)
 	, _state(nullptr)
 	, _context(msg.ctx)
@@ -112,6 +117,7 @@ Delta::Delta(Engine&                           engine,
 	, _properties{{msg.predicate, msg.value}}
 	, _object(nullptr)
 	, _graph(nullptr)
+	, _deadline_port(nullptr)
 	, _binding(nullptr)
 	, _state(nullptr)
 	, _context(msg.ctx)
@@ -181,6 +187,76 @@ get_file_node(LilvWorld* lworld, const URIs& uris, const Atom& value)
 	return nullptr;
 }
 
+/** Recompile the graph of an output whose deadline changed.
+ *
+ * Blocks in subgraphs inherit the deadline of the subgraph block, so every
+ * subgraph that feeds the output is recompiled as well.
+ */
+bool
+Delta::compile_deadlines(PortImpl& port)
+{
+	auto* const graph = dynamic_cast<GraphImpl*>(port.parent());
+	if (!graph || !port.is_output() || !graph->enabled()) {
+		return true;
+	}
+
+	std::set<BlockImpl*>    feeding;
+	std::vector<BlockImpl*> pending;
+	for (auto& arc : static_cast<DuplexPort&>(port).arcs()) {
+		if (arc.tail()->parent() != graph) {
+			pending.push_back(arc.tail()->parent_block());
+		}
+	}
+
+	while (!pending.empty()) {
+		BlockImpl* const block = pending.back();
+		pending.pop_back();
+		if (feeding.insert(block).second) {
+			for (auto* provider : block->providers()) {
+				pending.push_back(provider);
+			}
+		}
+	}
+
+	auto cg = compile(*_engine.maid(), *graph);
+	if (!cg) {
+		return false;
+	}
+
+	_deadline_graphs.emplace_back(graph, std::move(cg));
+	for (auto* block : feeding) {
+		auto* const subgraph = dynamic_cast<GraphImpl*>(block);
+		if (subgraph && !compile_subgraphs(*subgraph)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** Recompile `graph` and every graph within it, if enabled. */
+bool
+Delta::compile_subgraphs(GraphImpl& graph)
+{
+	if (graph.enabled()) {
+		auto cg = compile(*_engine.maid(), graph);
+		if (!cg) {
+			return false;
+		}
+
+		_deadline_graphs.emplace_back(&graph, std::move(cg));
+	}
+
+	for (auto& b : graph.blocks()) {
+		auto* const subgraph = dynamic_cast<GraphImpl*>(&b);
+		if (subgraph && !compile_subgraphs(*subgraph)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 bool
 Delta::pre_process(PreProcessContext& ctx)
 {
@@ -286,6 +362,9 @@ Delta::pre_process(PreProcessContext& ctx)
 		if (_object) {
 			_removed.emplace(key, value);
 			_object->remove_property(key, value);
+			if (key == uris.ingen_deadline) {
+				_deadline_port = dynamic_cast<PortImpl*>(_object);
+			}
 		} else if (is_engine && key == uris.ingen_loadedBundle) {
  			LilvWorld* lworld = _engine.world().lilv_world();
 			LilvNode*  bundle = get_file_node(lworld, uris, value);
@@ -320,6 +399,9 @@ Delta::pre_process(PreProcessContext& ctx)
 					_object->properties().erase(q);
 					_object->on_property_removed(r.first, r.second);
 					_removed.insert(r);
+					if (r.first == uris.ingen_deadline) {
+						_deadline_port = dynamic_cast<PortImpl*>(_object);
+					}
 				}
 
 				q = next;
@@ -369,6 +451,19 @@ Delta::pre_process(PreProcessContext& ctx)
 				} else if (key == uris.lv2_index) {
 					op = SpecialType::PORT_INDEX;
 					port->set_property(key, value);
+				} else if (key == uris.ingen_deadline) {
+					auto* const graph = dynamic_cast<GraphImpl*>(port->parent());
+					if (!graph || !port->is_output()) {
+						_status = Status::BAD_OBJECT_TYPE;
+					} else if (value.type() != uris.forge.Float) {
+						_status = Status::BAD_VALUE_TYPE;
+					} else if (value.get<float>() <= 0.0f ||
+					           value.get<float>() > 1.0f) {
+						_status = Status::BAD_VALUE;
+					} else {
+						op             = SpecialType::DEADLINE;
+						_deadline_port = port;
+					}
 				}
 			} else if ((block = dynamic_cast<BlockImpl*>(_object))) {
 				if (key == uris.midi_binding && value == uris.patch_wildcard) {
@@ -402,6 +497,20 @@ Delta::pre_process(PreProcessContext& ctx)
 					} else {
 						_status = Status::BAD_VALUE;
 					}
+				} else if (key == uris.ingen_sharedInstance) {
+					auto* const lv2_block = dynamic_cast<LV2Block*>(block);
+					if (!lv2_block) {
+						_status = Status::BAD_OBJECT_TYPE;
+					} else if (value.type() != uris.forge.Bool) {
+						_status = Status::BAD_VALUE_TYPE;
+					} else {
+						op = SpecialType::SHARED_INSTANCE;
+						lv2_block->set_shared_instance(value.get<int32_t>());
+						if (!lv2_block->prepare_poly(*_engine.buffer_factory(),
+						                             lv2_block->polyphony())) {
+							_status = Status::CREATION_FAILED;
+						}
+					}
 				}
 			}
 
@@ -455,6 +564,12 @@ Delta::pre_process(PreProcessContext& ctx)
 		} else if (is_client && key == uris.ingen_broadcast) {
 			_engine.broadcaster()->set_broadcast(
 				_request_client, value.get<int32_t>());
+		} else if (is_engine && key == uris.ingen_profile) {
+			if (value.type() == uris.forge.Bool) {
+				_engine.profiler()->set_enabled(value.get<int32_t>());
+			} else {
+				_status = Status::BAD_VALUE_TYPE;
+			}
 		} else if (is_engine && key == uris.ingen_loadedBundle) {
  			LilvWorld* lworld = _engine.world().lilv_world();
 			LilvNode*  bundle = get_file_node(lworld, uris, value);
@@ -480,6 +595,12 @@ Delta::pre_process(PreProcessContext& ctx)
 		_types.push_back(op);
 	}
 
+	// Recompile once all deadline changes have been applied
+	if (_deadline_port && _status == Status::NOT_PREPARED &&
+	    !compile_deadlines(*_deadline_port)) {
+		_status = Status::COMPILATION_FAILED;
+	}
+
 	for (auto& s : _set_events) {
 		s->pre_process(ctx);
 	}
@@ -550,6 +671,13 @@ Delta::execute(RunContext& ctx)
 				}
 			}
 		} break;
+		case SpecialType::SHARED_INSTANCE:
+			if (block) {
+				block->apply_poly(ctx, block->polyphony());
+			}
+			break;
+		case SpecialType::DEADLINE:
+			break;  // Graphs are recompiled for any change, see below
 		case SpecialType::POLYPHONY:
 			if (_graph &&
 			    !_graph->apply_internal_poly(ctx,
@@ -593,6 +721,10 @@ Delta::execute(RunContext& ctx)
 			break;
 		}
 	}
+
+	for (auto& g : _deadline_graphs) {
+		g.first->set_compiled_graph(std::move(g.second));
+	}
 }
 
 void
@@ -687,6 +819,14 @@ Delta::get_execution() const
 	return _block ? Execution::ATOMIC : Execution::NORMAL;
 }
 
+bool
+Delta::is_urgent() const
+{
+	// Urgent if every property is a port value
+	return !_create_event && !_state && _remove.empty() &&
+	       !_set_events.empty() && _set_events.size() == _properties.size();
+}
+
 } // namespace events
 } // namespace server
 } // namespace ingen
@@ -32,6 +32,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace ingen {
@@ -88,6 +89,8 @@ public:
 
 	Execution get_execution() const override;
 
+	bool is_urgent() const override;
+
 private:
 	enum class Type { SET, PUT, PATCH };
 
@@ -97,6 +100,8 @@ private:
 		ENABLE_BROADCAST,
 		POLYPHONY,
 		POLYPHONIC,
+		SHARED_INSTANCE,
+		DEADLINE,
 		PORT_INDEX,
 		CONTROL_BINDING,
 		PRESET,
@@ -105,8 +110,14 @@ private:
 
 	using SetEvents = std::vector<std::unique_ptr<SetPortValue>>;
 
+	using CompiledGraphs =
+		std::vector<std::pair<GraphImpl*, raul::managed_ptr<CompiledGraph>>>;
+
 	void init();
 
+	bool compile_deadlines(PortImpl& port);
+	bool compile_subgraphs(GraphImpl& graph);
+
 	std::unique_ptr<Event>           _create_event;
 	SetEvents                        _set_events;
 	std::vector<SpecialType>         _types;
@@ -118,6 +129,8 @@ private:
 	ingen::Resource*                 _object;
 	GraphImpl*                       _graph;
 	raul::managed_ptr<CompiledGraph> _compiled_graph;
+	CompiledGraphs                   _deadline_graphs;
+	PortImpl*                        _deadline_port;
 	ControlBindings::Binding*        _binding;
 	StatePtr                         _state;
 	Resource::Graph                  _context;
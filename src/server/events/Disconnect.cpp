@@ -97,8 +97,9 @@ Disconnect::Impl::Impl(Engine&     e,
 	if (_head->num_arcs() == 0) {
 		if (!_head->is_driver_port()) {
 			BufferFactory& bufs = *_engine.buffer_factory();
-			_voices = bufs.maid().make_managed<PortImpl::Voices>(_head->poly());
-			_head->pre_get_buffers(bufs, _voices, _head->poly());
+			_voices = bufs.maid().make_managed<PortImpl::Voices>(
+				_head->allocated_poly());
+			_head->pre_get_buffers(bufs, _voices, _head->allocated_poly());
 
 			if (_head->is_a(PortType::CONTROL) ||
 			    _head->is_a(PortType::CV)) {
@@ -20,7 +20,10 @@
 #include "Broadcaster.hpp"
 #include "Engine.hpp"
 #include "GraphImpl.hpp"
+#include "LV2Block.hpp"
 #include "PortImpl.hpp"
+#include "Profiler.hpp"
+#include "Worker.hpp"
 
 #include "ingen/Forge.hpp"
 #include "ingen/Interface.hpp"
@@ -33,9 +36,11 @@
 #include "ingen/World.hpp"
 #include "ingen/paths.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 
 namespace ingen {
 namespace server {
@@ -49,12 +54,39 @@ Get::Get(Engine&                           engine,
 	, _msg(msg)
 	, _object(nullptr)
 	, _plugin(nullptr)
-{}
+	, _offset(0)
+	, _limit(0)
+	, _next_offset(0)
+{
+	apply_params();
+}
+
+void
+Get::apply_params()
+{
+	const URIs& uris = _engine.world().uris();
+	for (const auto& p : _msg.params) {
+		const Atom& value = p.second;
+		if (p.first == uris.ingen_depth && value.type() == uris.forge.Int) {
+			_response.depth = std::max(-1, value.get<int32_t>());
+		} else if (p.first == uris.ingen_offset &&
+		           value.type() == uris.forge.Int) {
+			_offset = uint32_t(std::max(0, value.get<int32_t>()));
+		} else if (p.first == uris.ingen_limit &&
+		           value.type() == uris.forge.Int) {
+			_limit = uint32_t(std::max(0, value.get<int32_t>()));
+		} else if (p.first == uris.ingen_content && value == uris.ingen_structure) {
+			_response.content = ClientUpdate::Content::STRUCTURE;
+		} else if (p.first == uris.ingen_content && value == uris.ingen_values) {
+			_response.content = ClientUpdate::Content::VALUES;
+		}
+	}
+}
 
 bool
 Get::pre_process(PreProcessContext&)
 {
-	std::lock_guard<Store::Mutex> lock(_engine.store()->mutex());
+	std::shared_lock<Store::Mutex> lock(_engine.store()->mutex());
 
 	const auto& uri = _msg.subject;
 	if (uri == "ingen:/plugins") {
@@ -68,7 +100,7 @@ Get::pre_process(PreProcessContext&)
 			const GraphImpl* graph = nullptr;
 			const PortImpl*  port  = nullptr;
 			if ((graph = dynamic_cast<const GraphImpl*>(_object))) {
-				_response.put_graph(graph);
+				_next_offset = _response.put_graph(graph, _offset, _limit);
 			} else if ((block = dynamic_cast<const BlockImpl*>(_object))) {
 				_response.put_block(block);
 			} else if ((port = dynamic_cast<const PortImpl*>(_object))) {
@@ -76,6 +108,29 @@ Get::pre_process(PreProcessContext&)
 			} else {
 				return Event::pre_process_done(Status::BAD_OBJECT_TYPE, uri);
 			}
+
+			const Properties profile = _engine.profiler()->properties(
+				_engine.world().uris(), _object);
+			if (!profile.empty()) {
+				_response.put(uri, profile);
+			}
+
+			if (block) {
+				const Properties stats =
+					block->statistics(_engine.world().uris());
+				if (!stats.empty()) {
+					_response.put(uri, stats);
+				}
+			}
+
+			const auto* lv2_block = dynamic_cast<const LV2Block*>(_object);
+			if (lv2_block) {
+				const Properties work = _engine.worker()->properties(
+					_engine.world().uris(), lv2_block);
+				if (!work.empty()) {
+					_response.put(uri, work);
+				}
+			}
 			return Event::pre_process_done(Status::SUCCESS);
 		}
 		return Event::pre_process_done(Status::NOT_FOUND, uri);
@@ -108,13 +163,31 @@ Get::post_process()
 				{ uris.bufsz_maxBlockLength,
 				  uris.forge.make(int32_t(_engine.block_length())) },
 				{ uris.ingen_numThreads,
-				  uris.forge.make(int32_t(_engine.n_threads())) } };
+				  uris.forge.make(int32_t(_engine.n_threads())) },
+				{ uris.ingen_profile,
+				  uris.forge.make(_engine.profiler()->enabled()) },
+				{ uris.ingen_degradation,
+				  uris.forge.make(_engine.degradation()) },
+				{ uris.ingen_latency,
+				  uris.forge.make(int32_t(_engine.latency())) } };
 
 			const Properties load_props = _engine.load_properties();
 			props.insert(load_props.begin(), load_props.end());
+
+			const Properties profile = _engine.profiler()->properties(
+				uris, nullptr);
+			props.insert(profile.begin(), profile.end());
 			_request_client->put(URI("ingen:/engine"), props);
 		} else {
 			_response.send(*_request_client);
+			if (_next_offset) {
+				// Tell the client where the next page of this graph starts
+				URIs& uris = _engine.world().uris();
+				_request_client->set_property(
+					_msg.subject,
+					uris.ingen_continuation,
+					uris.forge.make(int32_t(_next_offset)));
+			}
 		}
 	}
 }
@@ -24,6 +24,7 @@
 #include "Event.hpp"
 #include "types.hpp"
 
+#include <cstdint>
 #include <memory>
 
 namespace ingen {
@@ -41,6 +42,10 @@ class RunContext;
 namespace events {
 
 /** A request from a client to send an object.
+ *
+ * Graphs may be requested in pages, with only structure or only values, and
+ * to a limited depth, so large graphs can be fetched without stalling the
+ * engine or the client.
  *
  * \ingroup engine
  */
@@ -57,11 +62,16 @@ public:
 	void post_process() override;
 
 private:
+	void apply_params();
+
 	const ingen::Get      _msg;
 	const Node*           _object;
 	PluginImpl*           _plugin;
 	BlockFactory::Plugins _plugins;
 	ClientUpdate          _response;
+	uint32_t              _offset;
+	uint32_t              _limit;
+	uint32_t              _next_offset;
 };
 
 } // namespace events
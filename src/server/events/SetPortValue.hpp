@@ -60,6 +60,8 @@ public:
 	void execute(RunContext& ctx) override;
 	void post_process() override;
 
+	bool is_urgent() const override { return true; }
+
 	bool synthetic() const { return _synthetic; }
 
 private:
@@ -25,7 +25,7 @@
 #include "ingen/Status.hpp"
 #include "lv2/atom/atom.h"
 
-#include <deque>
+#include <cstddef>
 #include <memory>
 
 namespace ingen {
@@ -63,15 +63,15 @@ Undo::pre_process(PreProcessContext&)
 	const Event::Mode orig_mode = _engine.event_writer()->get_event_mode();
 	_entry = stack->pop();
 	_engine.event_writer()->set_event_mode(mode);
-	if (_entry.events.size() > 1) {
+	if (_entry.size() > 1) {
 		_engine.interface()->bundle_begin();
 	}
 
-	for (const LV2_Atom* ev : _entry.events) {
-		_engine.atom_interface()->write(ev);
+	for (size_t i = 0; i < _entry.size(); ++i) {
+		_engine.atom_interface()->write(_entry.event(i));
 	}
 
-	if (_entry.events.size() > 1) {
+	if (_entry.size() > 1) {
 		_engine.interface()->bundle_end();
 	}
 	_engine.event_writer()->set_event_mode(orig_mode);
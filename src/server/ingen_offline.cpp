@@ -0,0 +1,82 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Engine.hpp"
+#include "OfflineDriver.hpp"
+
+#include "ingen/Atom.hpp"
+#include "ingen/Configuration.hpp"
+#include "ingen/FilePath.hpp"
+#include "ingen/Log.hpp"
+#include "ingen/Module.hpp"
+#include "ingen/World.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace ingen {
+namespace server {
+
+class Driver;
+
+struct OfflineModule : public Module {
+	void load(World& world) override {
+		server::Engine* const engine =
+		    static_cast<server::Engine*>(world.engine().get());
+
+		if (engine->driver()) {
+			world.log().warn("Engine already has a driver\n");
+			return;
+		}
+
+		const Configuration& conf   = world.conf();
+		const Atom&          input  = conf.option("render-input");
+		const Atom&          output = conf.option("render");
+		const auto           rate   = SampleRate(
+			std::max(1, conf.option("render-rate").get<int32_t>()));
+		const auto           length = uint64_t(
+			std::max(0, conf.option("render-length").get<int32_t>())) * rate;
+
+		if (length > std::numeric_limits<SampleCount>::max()) {
+			world.log().error("Render length is too long at this rate\n");
+			return;
+		}
+
+		auto* driver = new server::OfflineDriver(
+			*engine,
+			input.is_valid() ? FilePath(input.ptr<char>()) : FilePath(),
+			FilePath(output.ptr<char>()),
+			rate,
+			SampleCount(length));
+
+		engine->set_driver(std::shared_ptr<server::Driver>(driver));
+	}
+};
+
+} // namespace server
+} // namespace ingen
+
+extern "C" {
+
+ingen::Module*
+ingen_module_load()
+{
+	return new ingen::server::OfflineModule();
+}
+
+} // extern "C"
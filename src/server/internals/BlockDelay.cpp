@@ -19,10 +19,12 @@
 #include "BlockImpl.hpp"
 #include "Buffer.hpp"
 #include "BufferFactory.hpp"
+#include "GraphImpl.hpp"
 #include "InputPort.hpp"
 #include "InternalPlugin.hpp"
 #include "OutputPort.hpp"
 #include "PortType.hpp"
+#include "RunContext.hpp"
 
 #include "ingen/Forge.hpp"
 #include "ingen/URI.hpp"
@@ -31,13 +33,11 @@
 #include "raul/Maid.hpp"
 #include "raul/Symbol.hpp"
 
+#include <algorithm>
 #include <memory>
 
 namespace ingen {
 namespace server {
-
-class RunContext;
-
 namespace internals {
 
 InternalPlugin* BlockDelayNode::internal_plugin(URIs& uris) {
@@ -52,6 +52,8 @@ BlockDelayNode::BlockDelayNode(InternalPlugin*     plugin,
                                GraphImpl*          parent,
                                SampleRate          srate)
 	: InternalBlock(plugin, symbol, polyphonic, parent, srate)
+	, _delay(0)
+	, _pos(0)
 {
 	const ingen::URIs& uris = bufs.uris();
 	_ports = bufs.maid().make_managed<Ports>(2);
@@ -77,6 +79,9 @@ BlockDelayNode::activate(BufferFactory& bufs)
 {
 	_buffer = bufs.create(
 		bufs.uris().atom_Sound, 0, bufs.audio_buffer_size());
+	_buffer->clear();
+	_delay = 0;
+	_pos   = 0;
 
 	BlockImpl::activate(bufs);
 }
@@ -84,11 +89,31 @@ BlockDelayNode::activate(BufferFactory& bufs)
 void
 BlockDelayNode::run(RunContext& ctx)
 {
-	// Copy buffer from last cycle to output
-	_out_port->buffer(0)->copy(ctx, _buffer.get());
-
-	// Copy input from this cycle to buffer
-	_buffer->copy(ctx, _in_port->buffer(0).get());
+	/* Delay by the length of a block, which is the internal block length if
+	   the parent graph runs children in slices.  The delay is the same for
+	   every slice, including a shorter last slice of a cycle. */
+	const SampleCount capacity = _buffer->capacity() / sizeof(Sample);
+	const SampleCount delay    =
+		std::min(std::max(parent_graph()->slice_length(), 1U), capacity);
+
+	if (delay != _delay) {
+		// Delay length changed, start again from silence
+		_buffer->clear();
+		_delay = delay;
+		_pos   = 0;
+	}
+
+	const SampleCount offset  = ctx.offset();
+	const SampleCount nframes = ctx.nframes();
+	const Buffer&     in      = *_in_port->buffer(0);
+	Sample* const     out     = _out_port->buffer(0)->samples() + offset;
+	Sample* const     ring    = _buffer->samples();
+
+	for (SampleCount i = 0; i < nframes; ++i) {
+		out[i]     = ring[_pos];
+		ring[_pos] = in.is_audio() ? in.samples()[offset + i] : in.value_at(0);
+		_pos       = (_pos + 1 == _delay) ? 0 : _pos + 1;
+	}
 }
 
 } // namespace internals
@@ -61,7 +61,9 @@ public:
 private:
 	InputPort*  _in_port;
 	OutputPort* _out_port;
-	BufferRef   _buffer;
+	BufferRef   _buffer;  ///< Ring of delayed input
+	SampleCount _delay;   ///< Delay length in frames
+	SampleCount _pos;     ///< Read and write position in ring
 };
 
 } // namespace internals
@@ -17,9 +17,11 @@
 #include "internals/Note.hpp"
 
 #include "BlockImpl.hpp"
+#include "Broadcaster.hpp"
 #include "Buffer.hpp"
 #include "BufferFactory.hpp"
 #include "BufferRef.hpp"
+#include "Engine.hpp"
 #include "InputPort.hpp"
 #include "InternalPlugin.hpp"
 #include "OutputPort.hpp"
@@ -29,7 +31,9 @@
 #include "ingen/Atom.hpp"
 #include "ingen/Forge.hpp"
 #include "ingen/URI.hpp"
+#include "ingen/URIMap.hpp"
 #include "ingen/URIs.hpp"
+#include "ingen/World.hpp"
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
 #include "lv2/midi/midi.h"
@@ -37,9 +41,12 @@
 #include "raul/Maid.hpp"
 #include "raul/Symbol.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <iterator>
 #include <memory>
+#include <string>
 #include <utility>
 
 // #define NOTE_DEBUG 1
@@ -51,6 +58,8 @@ class GraphImpl;
 
 namespace internals {
 
+constexpr uint32_t NoteNode::NONE;
+
 InternalPlugin* NoteNode::internal_plugin(URIs& uris) {
 	return new InternalPlugin(
 		uris, URI(NS_INTERNALS "Note"), raul::Symbol("note"));
@@ -64,9 +73,22 @@ NoteNode::NoteNode(InternalPlugin*     plugin,
                    SampleRate          srate)
 	: InternalBlock(plugin, symbol, polyphonic, parent, srate)
 	, _voices(bufs.maid().make_managed<Voices>(_polyphony))
+	, _next_voice(0)
+	, _allocation(Allocation::OLDEST)
+	, _voice_steals_urid(bufs.engine().world().uri_map().map_uri(
+		  NS_INTERNALS "voiceSteals"))
+	, _max_voices_urid(bufs.engine().world().uri_map().map_uri(
+		  NS_INTERNALS "maxVoices"))
+	, _voice_steals(0)
+	, _max_voices(0)
+	, _stats_dirty(false)
 	, _sustain(false)
 {
 	const ingen::URIs& uris = bufs.uris();
+
+	std::fill(std::begin(_note_voices), std::end(_note_voices), NONE);
+	rebuild_lists();
+
 	_ports = bufs.maid().make_managed<Ports>(8);
 
 	const Atom zero = bufs.forge().make(0.0f);
@@ -138,6 +160,109 @@ NoteNode::NoteNode(InternalPlugin*     plugin,
 	_ports->at(7) = _pressure_port;
 }
 
+template<typename Elems>
+void
+NoteNode::list_insert(List& list, Elems& elems, uint32_t i, uint32_t after)
+{
+	elems[i].prev = after;
+	if (after == NONE) {
+		elems[i].next = list.head;
+		list.head     = i;
+	} else {
+		elems[i].next     = elems[after].next;
+		elems[after].next = i;
+	}
+
+	if (elems[i].next == NONE) {
+		list.tail = i;
+	} else {
+		elems[elems[i].next].prev = i;
+	}
+
+	++list.size;
+}
+
+template<typename Elems>
+void
+NoteNode::list_remove(List& list, Elems& elems, uint32_t i)
+{
+	if (elems[i].prev == NONE) {
+		list.head = elems[i].next;
+	} else {
+		elems[elems[i].prev].next = elems[i].next;
+	}
+
+	if (elems[i].next == NONE) {
+		list.tail = elems[i].prev;
+	} else {
+		elems[elems[i].next].prev = elems[i].prev;
+	}
+
+	elems[i].prev = elems[i].next = NONE;
+	--list.size;
+}
+
+NoteNode::List&
+NoteNode::voice_list(Voice::State state)
+{
+	switch (state) {
+	case Voice::State::FREE:
+		return _free;
+	case Voice::State::HOLDING:
+		return _held;
+	case Voice::State::ACTIVE:
+		break;
+	}
+	return _active;
+}
+
+void
+NoteNode::set_voice_state(uint32_t voice_num, Voice::State state)
+{
+	Voice& voice = (*_voices)[voice_num];
+
+	list_remove(voice_list(voice.state), *_voices, voice_num);
+	voice.state = state;
+
+	List& list = voice_list(state);
+	list_insert(list, *_voices, voice_num, list.tail);
+}
+
+void
+NoteNode::rebuild_lists()
+{
+	_free   = List();
+	_held   = List();
+	_active = List();
+
+	for (uint32_t i = 0; i < _polyphony; ++i) {
+		Voice& voice = (*_voices)[i];
+		voice.prev = voice.next = NONE;
+
+		// Keep each list ordered by time (only done when polyphony changes)
+		List&    list  = voice_list(voice.state);
+		uint32_t after = list.tail;
+		while (after != NONE && (*_voices)[after].time > voice.time) {
+			after = (*_voices)[after].prev;
+		}
+		list_insert(list, *_voices, i, after);
+	}
+
+	// Keys assigned to voices that no longer exist wait for a free voice
+	for (uint32_t k = 0; k < 128; ++k) {
+		Key& key = _keys[k];
+		if (key.state == Key::State::ON_ASSIGNED && key.voice >= _polyphony) {
+			key.state = Key::State::ON_UNASSIGNED;
+			list_insert(_unassigned, _keys, k, _unassigned.tail);
+		}
+		if (_note_voices[k] != NONE && _note_voices[k] >= _polyphony) {
+			_note_voices[k] = NONE;
+		}
+	}
+
+	_next_voice = (_next_voice < _polyphony) ? _next_voice : 0;
+}
+
 bool
 NoteNode::prepare_poly(BufferFactory& bufs, uint32_t poly)
 {
@@ -170,9 +295,32 @@ NoteNode::apply_poly(RunContext& ctx, uint32_t poly)
 	}
 	assert(_polyphony <= _voices->size());
 
+	rebuild_lists();
+
 	return true;
 }
 
+void
+NoteNode::on_property(const URI& uri, const Atom& value)
+{
+	InternalBlock::on_property(uri, value);
+
+	Forge& forge = uris().forge;
+	if (uri == NS_INTERNALS "voiceAllocation" &&
+	    (forge.is_uri(value) || value.type() == forge.String)) {
+		const std::string str = forge.str(value, false);
+		if (str == NS_INTERNALS "oldest") {
+			_allocation = Allocation::OLDEST;
+		} else if (str == NS_INTERNALS "quietest") {
+			_allocation = Allocation::QUIETEST;
+		} else if (str == NS_INTERNALS "roundRobin") {
+			_allocation = Allocation::ROUND_ROBIN;
+		} else if (str == NS_INTERNALS "sameNote") {
+			_allocation = Allocation::SAME_NOTE;
+		}
+	}
+}
+
 void
 NoteNode::run(RunContext& ctx)
 {
@@ -232,6 +380,38 @@ NoteNode::run(RunContext& ctx)
 			}
 		}
 	}
+
+	update_stats(ctx);
+}
+
+void
+NoteNode::update_stats(RunContext& ctx)
+{
+	if (!_stats_dirty || !ctx.engine().broadcaster()->must_broadcast()) {
+		return;
+	}
+
+	const LV2_URID atom_Int     = _midi_in_port->bufs().uris().atom_Int;
+	const int32_t  voice_steals = _voice_steals.load(std::memory_order_relaxed);
+	const int32_t  max_voices   = _max_voices.load(std::memory_order_relaxed);
+	if (ctx.notify(_voice_steals_urid, ctx.start(), this,
+	               sizeof(int32_t), atom_Int, &voice_steals) &&
+	    ctx.notify(_max_voices_urid, ctx.start(), this,
+	               sizeof(int32_t), atom_Int, &max_voices)) {
+		_stats_dirty = false;
+	}
+	// Otherwise the ring is full, try again next cycle
+}
+
+Properties
+NoteNode::statistics(const URIs& uris) const
+{
+	// Also reported here for clients that connect after they last changed
+	return {
+		{URI(NS_INTERNALS "voiceSteals"),
+		 uris.forge.make(_voice_steals.load(std::memory_order_relaxed))},
+		{URI(NS_INTERNALS "maxVoices"),
+		 uris.forge.make(_max_voices.load(std::memory_order_relaxed))}};
 }
 
 static inline float
@@ -241,50 +421,82 @@ note_to_freq(uint8_t num)
 	return A4 * powf(2.0f, static_cast<float>(num - 57.0f) / 12.0f);
 }
 
+uint32_t
+NoteNode::quietest_voice(const List& list) const
+{
+	uint32_t quietest = list.head;
+	for (uint32_t i = list.head; i != NONE; i = (*_voices)[i].next) {
+		if ((*_voices)[i].velocity < (*_voices)[quietest].velocity) {
+			quietest = i;
+		}
+	}
+	return quietest;
+}
+
+uint32_t
+NoteNode::choose_voice(uint8_t note_num)
+{
+	switch (_allocation.load(std::memory_order_relaxed)) {
+	case Allocation::SAME_NOTE: {
+		const uint32_t v = _note_voices[note_num];
+		if (v != NONE && (*_voices)[v].note == note_num) {
+			return v;
+		}
+	} break;
+	case Allocation::ROUND_ROBIN:
+		// Use the next free voice in turn, if there is one
+		for (uint32_t i = 0; _free.size && i < _polyphony; ++i) {
+			const uint32_t v = (_next_voice + i) % _polyphony;
+			if ((*_voices)[v].state == Voice::State::FREE) {
+				_next_voice = (v + 1) % _polyphony;
+				return v;
+			}
+		}
+		break;
+	case Allocation::QUIETEST:
+		if (!_free.size) {
+			return quietest_voice(_held.size ? _held : _active);
+		}
+		break;
+	case Allocation::OLDEST:
+		break;
+	}
+
+	// Use the least recently freed voice, or steal the oldest
+	if (_free.size) {
+		return _free.head;
+	}
+	return _held.size ? _held.head : _active.head;
+}
+
 void
 NoteNode::note_on(RunContext& ctx, uint8_t note_num, uint8_t velocity, FrameTime time)
 {
 	assert(time >= ctx.start() && time <= ctx.end());
 	assert(note_num <= 127);
 
-	Key*     key       = &_keys[note_num];
-	Voice*   voice     = nullptr;
-	uint32_t voice_num = 0;
+	Key* key = &_keys[note_num];
 
 	if (key->state != Key::State::OFF) {
 		return;
 	}
 
-	// Look for free voices
-	for (uint32_t i=0; i < _polyphony; ++i) {
-		if ((*_voices)[i].state == Voice::State::FREE) {
-			voice = &(*_voices)[i];
-			voice_num = i;
-			break;
-		}
-	}
-
-	// If we didn't find a free one, steal the oldest
-	if (voice == nullptr) {
-		voice_num = 0;
-		voice = &(*_voices)[0];
-		FrameTime oldest_time = (*_voices)[0].time;
-		for (uint32_t i=1; i < _polyphony; ++i) {
-			if ((*_voices)[i].time < oldest_time) {
-				voice = &(*_voices)[i];
-				voice_num = i;
-				oldest_time = voice->time;
-			}
-		}
-	}
-	assert(voice != nullptr);
-	assert(voice == &(*_voices)[voice_num]);
+	const uint32_t voice_num = choose_voice(note_num);
+	Voice*         voice     = &(*_voices)[voice_num];
+	assert(voice_num < _polyphony);
 
 	// Update stolen key, if applicable
 	if (voice->state == Voice::State::ACTIVE) {
 		assert(_keys[voice->note].state == Key::State::ON_ASSIGNED);
 		assert(_keys[voice->note].voice == voice_num);
 		_keys[voice->note].state = Key::State::ON_UNASSIGNED;
+		list_insert(_unassigned, _keys, voice->note, _unassigned.tail);
+	}
+
+	// Count steals (retriggering a held voice for the same note is not one)
+	if (voice->state != Voice::State::FREE && voice->note != note_num) {
+		_voice_steals.fetch_add(1, std::memory_order_relaxed);
+		_stats_dirty = true;
 	}
 
 	// Store key information for later reallocation on note off
@@ -298,9 +510,18 @@ NoteNode::note_on(RunContext& ctx, uint8_t note_num, uint8_t velocity, FrameTime
 	                             voice->time == time);
 
 	// Trigger voice
-	voice->state = Voice::State::ACTIVE;
-	voice->note  = note_num;
-	voice->time  = time;
+	set_voice_state(voice_num, Voice::State::ACTIVE);
+	voice->note     = note_num;
+	voice->velocity = velocity;
+	voice->time     = time;
+
+	_note_voices[note_num] = voice_num;
+
+	const int32_t n_voices = static_cast<int32_t>(_active.size + _held.size);
+	if (n_voices > _max_voices.load(std::memory_order_relaxed)) {
+		_max_voices.store(n_voices, std::memory_order_relaxed);
+		_stats_dirty = true;
+	}
 
 	assert(_keys[voice->note].state == Key::State::ON_ASSIGNED);
 	assert(_keys[voice->note].voice == voice_num);
@@ -334,9 +555,12 @@ NoteNode::note_off(RunContext& ctx, uint8_t note_num, FrameTime time)
 			if ( ! _sustain) {
 				free_voice(ctx, key->voice, time);
 			} else {
-				(*_voices)[key->voice].state = Voice::State::HOLDING;
+				set_voice_state(key->voice, Voice::State::HOLDING);
 			}
 		}
+	} else if (key->state == Key::State::ON_UNASSIGNED) {
+		// Key lost its voice to a steal, it no longer wants one back
+		list_remove(_unassigned, _keys, note_num);
 	}
 
 	key->state = Key::State::OFF;
@@ -347,36 +571,30 @@ NoteNode::free_voice(RunContext& ctx, uint32_t voice, FrameTime time)
 {
 	assert(time >= ctx.start() && time <= ctx.end());
 
-	// Find a key to reassign to the freed voice (the newest, if there is one)
-	Key*    replace_key     = nullptr;
-	uint8_t replace_key_num = 0;
-
-	for (uint8_t i = 0; i <= 127; ++i) {
-		if (_keys[i].state == Key::State::ON_UNASSIGNED) {
-			if (replace_key == nullptr || _keys[i].time > replace_key->time) {
-				replace_key = &_keys[i];
-				replace_key_num = i;
-			}
-		}
-	}
+	// Reassign the freed voice to the most recently stolen key, if any
+	const uint32_t replace_key_num = _unassigned.tail;
 
-	if (replace_key != nullptr) {  // Found a key to assign to freed voice
-		assert(&_keys[replace_key_num] == replace_key);
+	if (replace_key_num != NONE) {  // Found a key to assign to freed voice
+		Key* const replace_key = &_keys[replace_key_num];
 		assert(replace_key->state == Key::State::ON_UNASSIGNED);
 
+		list_remove(_unassigned, _keys, replace_key_num);
+
 		// Change the freq but leave the gate high and don't retrigger
-		_freq_port->set_voice_value(ctx, voice, time, note_to_freq(replace_key_num));
+		_freq_port->set_voice_value(
+			ctx, voice, time, note_to_freq(replace_key_num));
 		_num_port->set_voice_value(ctx, voice, time, replace_key_num);
 
 		replace_key->state = Key::State::ON_ASSIGNED;
 		replace_key->voice = voice;
-		_keys[(*_voices)[voice].note].state = Key::State::ON_UNASSIGNED;
 		(*_voices)[voice].note = replace_key_num;
-		(*_voices)[voice].state = Voice::State::ACTIVE;
+		(*_voices)[voice].time = time;
+		set_voice_state(voice, Voice::State::ACTIVE);
+		_note_voices[replace_key_num] = voice;
 	} else {
 		// No new note for voice, deactivate (set gate low)
 		_gate_port->set_voice_value(ctx, voice, time, 0.0f);
-		(*_voices)[voice].state = Voice::State::FREE;
+		set_voice_state(voice, Voice::State::FREE);
 	}
 }
 
@@ -385,12 +603,18 @@ NoteNode::all_notes_off(RunContext& ctx, FrameTime time)
 {
 	assert(time >= ctx.start() && time <= ctx.end());
 
-	// FIXME: set all keys to Key::OFF?
+	for (auto& key : _keys) {
+		key.state = Key::State::OFF;
+		key.prev  = key.next = NONE;
+	}
+	_unassigned = List();
 
 	for (uint32_t i = 0; i < _polyphony; ++i) {
 		_gate_port->set_voice_value(ctx, i, time, 0.0f);
 		(*_voices)[i].state = Voice::State::FREE;
 	}
+
+	rebuild_lists();
 }
 
 void
@@ -406,10 +630,8 @@ NoteNode::sustain_off(RunContext& ctx, FrameTime time)
 
 	_sustain = false;
 
-	for (uint32_t i=0; i < _polyphony; ++i) {
-		if ((*_voices)[i].state == Voice::State::HOLDING) {
-			free_voice(ctx, i, time);
-		}
+	while (_held.head != NONE) {
+		free_voice(ctx, _held.head, time);
 	}
 }
 
@@ -422,11 +644,10 @@ NoteNode::bend(RunContext& ctx, FrameTime time, float amount)
 void
 NoteNode::note_pressure(RunContext& ctx, FrameTime time, uint8_t note_num, float amount)
 {
-	for (uint32_t i=0; i < _polyphony; ++i) {
-		if ((*_voices)[i].state != Voice::State::FREE && (*_voices)[i].note == note_num) {
-			_pressure_port->set_voice_value(ctx, i, time, amount);
-			return;
-		}
+	const uint32_t v = _note_voices[note_num];
+	if (v != NONE && (*_voices)[v].state != Voice::State::FREE &&
+	    (*_voices)[v].note == note_num) {
+		_pressure_port->set_voice_value(ctx, v, time, amount);
 	}
 }
 
@@ -20,9 +20,11 @@
 #include "InternalBlock.hpp"
 #include "types.hpp"
 
+#include "lv2/urid/urid.h"
 #include "raul/Array.hpp"
 #include "raul/Maid.hpp"
 
+#include <atomic>
 #include <cstdint>
 
 namespace raul {
@@ -31,6 +33,8 @@ class Symbol;
 
 namespace ingen {
 
+class Atom;
+class URI;
 class URIs;
 
 namespace server {
@@ -48,11 +52,23 @@ namespace internals {
  *
  * For pitched instruments like keyboard, etc.
  *
+ * Voices are kept in intrusive lists (free, held, and active, each ordered by
+ * the time the voice entered it) so that allocating, releasing, and stealing
+ * a voice is constant time in the common case, regardless of polyphony.
+ *
  * \ingroup engine
  */
 class NoteNode : public InternalBlock
 {
 public:
+	/** Policy for choosing a voice to play a new note. */
+	enum class Allocation {
+		OLDEST,       ///< Steal the oldest released, then oldest playing voice
+		QUIETEST,     ///< Steal the voice with the lowest velocity
+		ROUND_ROBIN,  ///< Cycle through voices in order
+		SAME_NOTE     ///< Reuse the voice that last played the same note
+	};
+
 	NoteNode(InternalPlugin*     plugin,
 	         BufferFactory&      bufs,
 	         const raul::Symbol& symbol,
@@ -65,6 +81,8 @@ public:
 
 	void run(RunContext& ctx) override;
 
+	Properties statistics(const URIs& uris) const override;
+
 	void note_on(RunContext& ctx, uint8_t note_num, uint8_t velocity, FrameTime time);
 	void note_off(RunContext& ctx, uint8_t note_num, FrameTime time);
 	void all_notes_off(RunContext& ctx, FrameTime time);
@@ -78,7 +96,12 @@ public:
 
 	static InternalPlugin* internal_plugin(URIs& uris);
 
+protected:
+	void on_property(const URI& uri, const Atom& value) override;
+
 private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
 	/** Key, one for each key on the keyboard */
 	struct Key {
 		enum class State { OFF, ON_ASSIGNED, ON_UNASSIGNED };
@@ -86,25 +109,66 @@ private:
 		State       state = State::OFF;
 		uint32_t    voice = 0;
 		SampleCount time  = 0;
+		uint32_t    prev  = NONE;  ///< Previous key in unassigned list
+		uint32_t    next  = NONE;  ///< Next key in unassigned list
 	};
 
 	/** Voice, one of these always exists for each voice */
 	struct Voice {
 		enum class State { FREE, ACTIVE, HOLDING };
 
-		State       state = State::FREE;
-		uint8_t     note  = 0;
-		SampleCount time  = 0;
+		State       state    = State::FREE;
+		uint8_t     note     = 0;
+		uint8_t     velocity = 0;
+		SampleCount time     = 0;
+		uint32_t    prev     = NONE;  ///< Previous voice in state list
+		uint32_t    next     = NONE;  ///< Next voice in state list
+	};
+
+	/** Doubly linked list of voice or key indices, oldest at the head. */
+	struct List {
+		uint32_t head = NONE;
+		uint32_t tail = NONE;
+		uint32_t size = 0;
 	};
 
 	using Voices = raul::Array<Voice>;
 
+	template<typename Elems>
+	static void list_insert(List& list, Elems& elems, uint32_t i, uint32_t after);
+
+	template<typename Elems>
+	static void list_remove(List& list, Elems& elems, uint32_t i);
+
+	List& voice_list(Voice::State state);
+	void  set_voice_state(uint32_t voice, Voice::State state);
+	void  rebuild_lists();
+
+	uint32_t choose_voice(uint8_t note_num);
+	uint32_t quietest_voice(const List& list) const;
+
 	void free_voice(RunContext& ctx, uint32_t voice, FrameTime time);
+	void update_stats(RunContext& ctx);
 
 	raul::managed_ptr<Voices> _voices;
 	raul::managed_ptr<Voices> _prepared_voices;
 
-	Key  _keys[128];
+	Key      _keys[128];
+	uint32_t _note_voices[128];  ///< Voice that most recently played each note
+	List     _free;              ///< Free voices, least recently freed first
+	List     _held;              ///< Released voices held by the sustain pedal
+	List     _active;            ///< Sounding voices, oldest first
+	List     _unassigned;        ///< Keys that lost their voice to a steal
+	uint32_t _next_voice;        ///< Next voice for round-robin allocation
+
+	std::atomic<Allocation> _allocation;
+
+	LV2_URID _voice_steals_urid;
+	LV2_URID _max_voices_urid;
+	std::atomic<int32_t> _voice_steals;  ///< Voices stolen since creation
+	std::atomic<int32_t> _max_voices;    ///< Most voices in use at once
+	bool     _stats_dirty;   ///< Stats changed since last notification
+
 	bool _sustain;  ///< Whether or not hold pedal is depressed
 
 	InputPort*  _midi_in_port;
@@ -55,16 +55,17 @@ mix(const RunContext&   ctx,
 		dst->copy(ctx, srcs[0]);
 
 		// Mix in the rest
-		Sample* __restrict const out = dst->samples();
-		const SampleCount        end = ctx.nframes();
+		Sample* __restrict const out   = dst->samples();
+		const SampleCount        begin = ctx.offset();
+		const SampleCount        end   = ctx.offset() + ctx.nframes();
 		for (uint32_t i = 1; i < num_srcs; ++i) {
 			const Sample* __restrict const in = srcs[i]->samples();
 			if (srcs[i]->is_control()) {  // control => audio
-				for (SampleCount j = 0; j < end; ++j) {
+				for (SampleCount j = begin; j < end; ++j) {
 					out[j] += in[0];
 				}
 			} else if (srcs[i]->is_audio()) {  // audio => audio
-				for (SampleCount j = 0; j < end; ++j) {
+				for (SampleCount j = begin; j < end; ++j) {
 					out[j] += in[j];
 				}
 			} else if (srcs[i]->is_sequence()) {  // sequence => audio
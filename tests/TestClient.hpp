@@ -17,6 +17,7 @@
 #ifndef INGEN_TESTCLIENT_HPP
 #define INGEN_TESTCLIENT_HPP
 
+#include "ingen/Atom.hpp"
 #include "ingen/Interface.hpp"
 #include "ingen/Log.hpp"
 #include "ingen/Message.hpp"
@@ -26,6 +27,7 @@
 #include <boost/variant/get.hpp>
 
 #include <cstdlib>
+#include <map>
 
 namespace ingen {
 
@@ -50,11 +52,34 @@ public:
 		} else if (const Error* const error = boost::get<Error>(&msg)) {
 			_log.error("error: %1%\n", error->message);
 			exit(EXIT_FAILURE);
+		} else if (const Put* const put = boost::get<Put>(&msg)) {
+			for (const auto& p : put->properties) {
+				_values[put->uri][p.first] = p.second;
+			}
+		} else if (const Delta* const delta = boost::get<Delta>(&msg)) {
+			for (const auto& p : delta->add) {
+				_values[delta->uri][p.first] = p.second;
+			}
+		} else if (const SetProperty* const set = boost::get<SetProperty>(&msg)) {
+			_values[set->subject][set->predicate] = set->value;
+		}
+	}
+
+	/** Return the last value received for a property, or null. */
+	const Atom* value(const URI& subject, const URI& predicate) const {
+		const auto s = _values.find(subject);
+		if (s != _values.end()) {
+			const auto p = s->second.find(predicate);
+			if (p != s->second.end()) {
+				return &p->second;
+			}
 		}
+		return nullptr;
 	}
 
 private:
-	Log& _log;
+	Log&                               _log;
+	std::map<URI, std::map<URI, Atom>> _values;
 };
 
 } // namespace ingen
@@ -0,0 +1,214 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ingen/Atom.hpp"
+#include "ingen/AtomReader.hpp"
+#include "ingen/AtomSink.hpp"
+#include "ingen/AtomWriter.hpp"
+#include "ingen/Clock.hpp"
+#include "ingen/Configuration.hpp"
+#include "ingen/Forge.hpp"
+#include "ingen/Interface.hpp"
+#include "ingen/Message.hpp"
+#include "ingen/Properties.hpp"
+#include "ingen/Resource.hpp"
+#include "ingen/URI.hpp"
+#include "ingen/URIs.hpp"
+#include "ingen/World.hpp"
+#include "ingen/runtime_paths.hpp"
+#include "lv2/atom/atom.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+namespace {
+
+std::atomic<size_t> n_allocations{0};
+
+} // namespace
+
+void*
+operator new(size_t size)
+{
+	++n_allocations;
+	if (void* ptr = malloc(size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+namespace ingen {
+namespace bench {
+namespace {
+
+const uint32_t n_blocks = 1U << 14U;
+
+/// Interface which discards every message
+class NullInterface : public Interface
+{
+public:
+	URI uri() const override { return URI("ingen:/clients/bench"); }
+
+	void message(const Message&) override {}
+};
+
+/// Sink which reads every message written back into an interface
+class LoopbackSink : public AtomSink
+{
+public:
+	explicit LoopbackSink(AtomReader& reader) : _reader(reader) {}
+
+	bool write(const LV2_Atom* msg, int32_t default_id) override {
+		return _reader.write(msg, default_id);
+	}
+
+private:
+	AtomReader& _reader;
+};
+
+/// Return the number of atoms in `props` which do not fit inline
+size_t
+n_heap_atoms(const Properties& props)
+{
+	size_t n = 0;
+	for (const auto& p : props) {
+		n += (p.second.size() > Atom::inline_size) ? 1 : 0;
+	}
+	return n;
+}
+
+int
+run(int argc, char** argv)
+{
+	std::unique_ptr<ingen::World> world;
+	try {
+		world = std::unique_ptr<ingen::World>{
+		    new ingen::World(nullptr, nullptr, nullptr)};
+
+		world->conf().add(
+			"output", "output", 'O', "File to write benchmark output",
+			ingen::Configuration::SESSION, world->forge().String, Atom());
+		world->load_configuration(argc, argv);
+	} catch (std::exception& e) {
+		std::cout << "ingen: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const Atom& out = world->conf().option("output");
+	if (!out.is_valid()) {
+		std::cerr << "Usage: ingen_atom_bench --output OUT_FILE" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	URIs&         uris  = world->uris();
+	Forge&        forge = world->forge();
+	NullInterface null_iface;
+	AtomReader    reader(world->uri_map(), uris, world->log(), null_iface);
+	LoopbackSink  sink(reader);
+	AtomWriter    writer(world->uri_map(), uris, sink);
+
+	/* Send what a client sees when a graph is loaded: each block is put with
+	   its properties, then a control port, then the port value is set. */
+	size_t         n_messages   = 0;
+	size_t         n_heap       = 0;
+	ingen::Clock   clock;
+	const size_t   allocs_start = n_allocations;
+	const uint64_t t_start      = clock.now_microseconds();
+	for (uint32_t i = 0; i < n_blocks; ++i) {
+		const std::string block = "ingen:/main/block" + std::to_string(i);
+		const URI         block_uri(block);
+		const URI         port_uri(block + "/gain");
+
+		const Properties block_props{
+			{uris.rdf_type, uris.ingen_Block.urid_atom()},
+			{uris.lv2_prototype,
+			 forge.alloc_uri("http://lv2plug.in/plugins/eg-amp")},
+			{uris.lv2_name, forge.alloc("Simple Amplifier")},
+			{uris.ingen_canvasX, forge.make(float(i))},
+			{uris.ingen_canvasY, forge.make(float(i))}};
+
+		const Properties port_props{
+			{uris.rdf_type, uris.lv2_InputPort.urid_atom()},
+			{uris.rdf_type, uris.lv2_ControlPort.urid_atom()},
+			{uris.lv2_symbol, forge.alloc("gain")},
+			{uris.lv2_name, forge.alloc("Gain")},
+			{uris.lv2_minimum, forge.make(-90.0f)},
+			{uris.lv2_maximum, forge.make(24.0f)},
+			{uris.ingen_value, forge.make(0.0f)}};
+
+		const auto ctx = Resource::Graph::DEFAULT;
+		writer.message(Put{0, block_uri, block_props, ctx});
+		writer.message(Put{0, port_uri, port_props, ctx});
+		writer.message(SetProperty{
+			0, port_uri, uris.ingen_value, forge.make(1.0f), ctx});
+
+		n_messages += 3;
+		n_heap += n_heap_atoms(block_props) + n_heap_atoms(port_props);
+	}
+	const uint64_t t_end    = clock.now_microseconds();
+	const size_t   n_allocs = n_allocations - allocs_start;
+
+	// Write log output
+	const std::string out_file = static_cast<const char*>(out.get_body());
+	std::unique_ptr<FILE, decltype(&fclose)> log{fopen(out_file.c_str(), "a"),
+	                                             &fclose};
+	if (ftell(log.get()) == 0) {
+		fprintf(log.get(),
+		        "# n_messages\trun_time\tallocations_per_message"
+		        "\theap_atoms_per_message\n");
+	}
+
+	fprintf(log.get(), "%zu\t%f\t%f\t%f\n",
+	        n_messages,
+	        (t_end - t_start) / 1000000.0,
+	        double(n_allocs) / n_messages,
+	        double(n_heap) / n_messages);
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace
+} // namespace bench
+} // namespace ingen
+
+int
+main(int argc, char** argv)
+{
+	ingen::set_bundle_path_from_code(
+	    reinterpret_cast<void (*)()>(&ingen::bench::n_heap_atoms));
+
+	return ingen::bench::run(argc, argv);
+}
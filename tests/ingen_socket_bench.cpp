@@ -0,0 +1,202 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ingen/Atom.hpp"
+#include "ingen/Clock.hpp"
+#include "ingen/Configuration.hpp"
+#include "ingen/Forge.hpp"
+#include "ingen/Interface.hpp"
+#include "ingen/Message.hpp"
+#include "ingen/SocketReader.hpp"
+#include "ingen/URI.hpp"
+#include "ingen/World.hpp"
+#include "ingen/runtime_paths.hpp"
+#include "lv2/patch/patch.h"
+#include "raul/Socket.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ingen {
+namespace bench {
+namespace {
+
+/// Interface which just counts the messages it receives
+class CountingInterface : public Interface
+{
+public:
+	URI uri() const override { return URI("ingen:/clients/bench"); }
+
+	void message(const Message&) override { ++count; }
+
+	std::atomic<uint32_t> count{0};
+};
+
+/// A client connection, with the reader on one end of a socket pair
+struct Client
+{
+	CountingInterface             iface;
+	int                           write_fd = -1;
+	std::unique_ptr<SocketReader> reader;
+};
+
+void
+write_messages(int fd, uint32_t n_messages)
+{
+	static const std::string msg =
+		"[] a <" LV2_PATCH__Get "> ; <" LV2_PATCH__subject "> <ingen:/> .\n";
+
+	for (uint32_t i = 0; i < n_messages; ++i) {
+		size_t offset = 0;
+		while (offset < msg.size()) {
+			const ssize_t n = write(fd, msg.c_str() + offset, msg.size() - offset);
+			if (n <= 0) {
+				return;
+			}
+			offset += static_cast<size_t>(n);
+		}
+	}
+}
+
+int
+run(int argc, char** argv)
+{
+	std::unique_ptr<ingen::World> world;
+	try {
+		world = std::unique_ptr<ingen::World>{
+		    new ingen::World(nullptr, nullptr, nullptr)};
+
+		world->conf().add(
+			"output", "output", 'O', "File to write benchmark output",
+			ingen::Configuration::SESSION, world->forge().String, Atom());
+		world->conf().add(
+			"clients", "clients", 'N', "Number of clients",
+			ingen::Configuration::SESSION, world->forge().Int,
+			world->forge().make(4));
+		world->conf().add(
+			"messages", "messages", 'M', "Number of messages per client",
+			ingen::Configuration::SESSION, world->forge().Int,
+			world->forge().make(10000));
+		world->load_configuration(argc, argv);
+	} catch (std::exception& e) {
+		std::cout << "ingen: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const Atom& out = world->conf().option("output");
+	if (!out.is_valid()) {
+		std::cerr << "Usage: ingen_socket_bench [--clients N] [--messages M] "
+		          << "--output OUT_FILE" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const auto n_clients  = world->conf().option("clients").get<int32_t>();
+	const auto n_messages = world->conf().option("messages").get<int32_t>();
+	if (n_clients < 1 || n_messages < 1) {
+		std::cerr << "error: clients and messages must be positive" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Connect a reader to each client socket
+	std::vector<std::unique_ptr<Client>> clients;
+	for (int32_t i = 0; i < n_clients; ++i) {
+		int fds[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) {
+			std::cerr << "error: socketpair failed (" << strerror(errno) << ")"
+			          << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		auto client      = std::make_unique<Client>();
+		client->write_fd = fds[1];
+		client->reader   = std::make_unique<SocketReader>(
+			*world,
+			client->iface,
+			std::make_shared<raul::Socket>(
+				raul::Socket::Type::UNIX, "unix:///bench", nullptr, 0, fds[0]));
+
+		clients.push_back(std::move(client));
+	}
+
+	// Send messages from every client at once
+	ingen::Clock             clock;
+	const uint64_t           t_start = clock.now_microseconds();
+	std::vector<std::thread> writers;
+	for (const auto& client : clients) {
+		writers.emplace_back(
+			write_messages, client->write_fd, uint32_t(n_messages));
+	}
+	for (auto& writer : writers) {
+		writer.join();
+	}
+
+	// Wait until every message has been parsed
+	for (const auto& client : clients) {
+		while (client->iface.count < uint32_t(n_messages)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+	const uint64_t t_end = clock.now_microseconds();
+
+	// Write log output
+	const std::string out_file = static_cast<const char*>(out.get_body());
+	std::unique_ptr<FILE, decltype(&fclose)> log{fopen(out_file.c_str(), "a"),
+	                                             &fclose};
+	if (ftell(log.get()) == 0) {
+		fprintf(log.get(), "# n_clients\trun_time\tmessages_per_second\n");
+	}
+
+	const double run_time = (t_end - t_start) / 1000000.0;
+	fprintf(log.get(), "%d\t%f\t%f\n",
+	        n_clients,
+	        run_time,
+	        (double(n_clients) * n_messages) / run_time);
+
+	// Shut down
+	for (const auto& client : clients) {
+		close(client->write_fd);
+		client->reader.reset();
+	}
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace
+} // namespace bench
+} // namespace ingen
+
+int
+main(int argc, char** argv)
+{
+	ingen::set_bundle_path_from_code(
+	    reinterpret_cast<void (*)()>(&ingen::bench::write_messages));
+
+	return ingen::bench::run(argc, argv);
+}
@@ -16,6 +16,7 @@
 
 #include "TestClient.hpp"
 
+#include "ingen/Atom.hpp"
 #include "ingen/Atom.hpp"
 #include "ingen/AtomForge.hpp"
 #include "ingen/AtomReader.hpp"
@@ -33,6 +34,8 @@
 #include "ingen/fmt.hpp"
 #include "ingen/memory.hpp"
 #include "ingen/runtime_paths.hpp"
+#include "lv2/atom/atom.h"
+#include "lv2/patch/patch.h"
 #include "raul/Path.hpp"
 #include "serd/serd.h"
 #include "sord/sordmm.hpp"
@@ -144,7 +147,7 @@ run(int argc, char** argv)
 	                       *world->interface());
 
 	// AtomWriter to serialise responses from the engine
-	std::shared_ptr<Interface> client(new TestClient(world->log()));
+	auto client = std::make_shared<TestClient>(world->log());
 
 	world->interface()->set_respondee(client);
 	world->engine()->register_client(client);
@@ -189,6 +192,34 @@ run(int argc, char** argv)
 		}
 
 		world->engine()->flush_events(std::chrono::milliseconds(20));
+
+		// Check the last value received for a property, if requested
+		const Sord::URI check(*world->rdf_world(),
+		                      fmt("check%1%", n_events),
+		                      reinterpret_cast<const char*>(cmds_file_uri.buf));
+		if (!cmds->find(check, nil, nil).end()) {
+			const Sord::Node subject_node = cmds->get(
+				check, Sord::URI(*world->rdf_world(), LV2_PATCH__subject), nil);
+			const Sord::Node property_node = cmds->get(
+				check, Sord::URI(*world->rdf_world(), LV2_PATCH__property), nil);
+			const Sord::Node value_node = cmds->get(
+				check, Sord::URI(*world->rdf_world(), LV2_PATCH__value), nil);
+
+			forge.clear();
+			forge.read(*world->rdf_world(), cmds->c_obj(), value_node.c_obj());
+
+			const LV2_Atom* const expected = forge.atom();
+			const Atom* const     actual   = client->value(
+				URI(subject_node.to_string()), URI(property_node.to_string()));
+			if (!actual || !(*actual == Atom(expected->size,
+			                                 expected->type,
+			                                 LV2_ATOM_BODY_CONST(expected)))) {
+				std::cerr << "error: unexpected value of "
+				          << property_node.to_string() << " on "
+				          << subject_node.to_string() << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
 	}
 
 	delete cmds;
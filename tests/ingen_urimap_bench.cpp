@@ -0,0 +1,141 @@
+/*
+  This file is part of Ingen.
+  Copyright 2020 David Robillard <http://drobilla.net/>
+
+  Ingen is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or any later version.
+
+  Ingen is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE.  See the GNU Affero General Public License for details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with Ingen.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ingen/Atom.hpp"
+#include "ingen/Clock.hpp"
+#include "ingen/Configuration.hpp"
+#include "ingen/Forge.hpp"
+#include "ingen/URIMap.hpp"
+#include "ingen/World.hpp"
+#include "ingen/runtime_paths.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ingen {
+namespace bench {
+namespace {
+
+const uint32_t n_uris    = 1U << 12U;
+const uint32_t n_lookups = 1U << 20U;
+
+/// Map and unmap URIs, half of which are new when the benchmark starts
+void
+map_uris(URIMap* map, const std::vector<std::string>* uris, unsigned offset)
+{
+	LV2_URID_Map&   urid_map   = map->urid_map();
+	LV2_URID_Unmap& urid_unmap = map->urid_unmap();
+
+	for (uint32_t i = 0; i < n_lookups; ++i) {
+		const std::string& uri = (*uris)[(i + offset) % uris->size()];
+		const LV2_URID     id  = urid_map.map(urid_map.handle, uri.c_str());
+		const char* const  str = urid_unmap.unmap(urid_unmap.handle, id);
+		if (!str || strcmp(str, uri.c_str())) {
+			std::cerr << "error: <" << uri << "> mapped incorrectly"
+			          << std::endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+int
+run(int argc, char** argv)
+{
+	std::unique_ptr<ingen::World> world;
+	try {
+		world = std::unique_ptr<ingen::World>{
+		    new ingen::World(nullptr, nullptr, nullptr)};
+
+		world->conf().add(
+			"output", "output", 'O', "File to write benchmark output",
+			ingen::Configuration::SESSION, world->forge().String, Atom());
+		world->load_configuration(argc, argv);
+	} catch (std::exception& e) {
+		std::cout << "ingen: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const Atom& out = world->conf().option("output");
+	if (!out.is_valid()) {
+		std::cerr << "Usage: ingen_urimap_bench [--threads N] --output OUT_FILE"
+		          << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const auto n_threads =
+		std::max(world->conf().option("threads").get<int32_t>(), 1);
+
+	// Make URIs, and map half of them up front
+	URIMap&                  map = world->uri_map();
+	std::vector<std::string> uris;
+	for (uint32_t i = 0; i < n_uris; ++i) {
+		uris.emplace_back("http://example.org/bench#uri" + std::to_string(i));
+		if (i % 2) {
+			map.map_uri(uris.back());
+		}
+	}
+
+	// Hammer the map from every thread at once
+	ingen::Clock             clock;
+	const uint64_t           t_start = clock.now_microseconds();
+	std::vector<std::thread> threads;
+	for (int32_t i = 0; i < n_threads; ++i) {
+		threads.emplace_back(
+			map_uris, &map, &uris, unsigned(i) * (n_uris / n_threads));
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	const uint64_t t_end = clock.now_microseconds();
+
+	// Write log output
+	const std::string out_file = static_cast<const char*>(out.get_body());
+	std::unique_ptr<FILE, decltype(&fclose)> log{fopen(out_file.c_str(), "a"),
+	                                             &fclose};
+	if (ftell(log.get()) == 0) {
+		fprintf(log.get(), "# n_threads\trun_time\tlookups_per_second\n");
+	}
+
+	const double run_time = (t_end - t_start) / 1000000.0;
+	fprintf(log.get(), "%d\t%f\t%f\n",
+	        n_threads,
+	        run_time,
+	        (double(n_threads) * n_lookups) / run_time);
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace
+} // namespace bench
+} // namespace ingen
+
+int
+main(int argc, char** argv)
+{
+	ingen::set_bundle_path_from_code(
+	    reinterpret_cast<void (*)()>(&ingen::bench::map_uris));
+
+	return ingen::bench::run(argc, argv);
+}